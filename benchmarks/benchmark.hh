@@ -0,0 +1,112 @@
+#ifndef AUTOMATICDIFFERENTIATION_BENCHMARK_HH_1729182046815537218_
+#define AUTOMATICDIFFERENTIATION_BENCHMARK_HH_1729182046815537218_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace bench {
+// Keeps the compiler from optimizing away the computation of `x`
+template <typename T>
+inline void do_not_optimize(const T& x) noexcept {
+#if defined(__GNUC__)
+  asm volatile("" : : "r,m"(x) : "memory");
+#else
+  static volatile const T* sink;
+  sink = &x;
+#endif
+}
+
+struct result {
+  double ns_per_eval;
+  double evals_per_second;
+};
+
+// Calls `f(i)` for increasing `i` until a run takes at least `min_duration`
+// and returns the fastest of `repetitions` runs of that length
+template <typename F>
+result measure(F f, std::size_t repetitions = 5) {
+  using clock = std::chrono::steady_clock;
+  constexpr std::chrono::nanoseconds min_duration =
+      std::chrono::milliseconds(20);
+
+  const auto run = [&](std::size_t n) {
+    const auto start = clock::now();
+    for (std::size_t i = 0; i < n; ++i) {
+      do_not_optimize(f(i));
+    }
+    return clock::now() - start;
+  };
+
+  std::size_t n = 1;
+  while (run(n) < min_duration) {
+    n *= 2;
+  }
+  auto best = run(n);
+  for (std::size_t r = 1; r < repetitions; ++r) {
+    best = std::min(best, run(n));
+  }
+  const double ns =
+      static_cast<double>(std::chrono::nanoseconds(best).count())
+      / static_cast<double>(n);
+  return {ns, 1e9 / ns};
+}
+
+// Prints one comma-separated line per benchmark. `relative` is the time per
+// evaluation divided by the one of the handwritten baseline of the same
+// benchmark.
+class report {
+public:
+  explicit report(std::string_view filter) : _filter(filter) {
+#if defined(__OPTIMIZE__)
+    std::puts("# optimized build");
+#else
+    std::puts("# unoptimized build, numbers are not meaningful");
+#endif
+    std::puts("benchmark,variant,ns_per_eval,evals_per_second,relative");
+  }
+
+  bool enabled(std::string_view name) const noexcept {
+    return name.find(_filter) != std::string_view::npos;
+  }
+
+  // The first variant of each benchmark is taken as baseline
+  template <typename F>
+  void add(std::string_view name, std::string_view variant, F f) {
+    if (!enabled(name)) {
+      return;
+    }
+    const result r = measure(f);
+    if (name != _name) {
+      _name     = name;
+      _baseline = r.ns_per_eval;
+    }
+    std::printf(
+        "%.*s,%.*s,%.3f,%.0f,%.3f\n",
+        static_cast<int>(name.size()),
+        name.data(),
+        static_cast<int>(variant.size()),
+        variant.data(),
+        r.ns_per_eval,
+        r.evals_per_second,
+        r.ns_per_eval / _baseline
+    );
+  }
+
+private:
+  std::string_view _filter;
+  std::string _name;
+  double _baseline = 1;
+};
+
+// Deterministic input that changes with `i` so that evaluations cannot be
+// hoisted out of the loop
+constexpr double input(std::size_t i, double base = 0.5) noexcept {
+  return base + 1e-6 * static_cast<double>(i & 1023);
+}
+} // namespace bench
+
+#endif // AUTOMATICDIFFERENTIATION_BENCHMARK_HH_1729182046815537218_
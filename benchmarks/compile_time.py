@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""Measures the cost of instantiating derivatives of increasing order.
+
+For every expression shape and derivative order a translation unit taking the
+derivative with respect to the variables in alternating and in reversed order
+is generated and compiled with `-fsyntax-only`. The compiler's wall
+time, CPU time and peak memory are printed as comma-separated values.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+SHAPES = {
+    "polynomial": ("3_c * x * x * x - 2_c * x * x + x - 5_c", "x"),
+    "transcendental": ("ad::exp(ad::sin(x)) * ad::log(1_c + x * x)", "x"),
+    "quotient": ("(x + 1_c) / (x * x + 2_c)", "x"),
+    "power": ("ad::pow(x, y) + ad::sqrt(x * y)", "xy"),
+    "mixed": ("ad::exp(x * y) * ad::sin(z) + x * y * z", "xyz"),
+}
+
+SOURCE = """#include "ad/ad.hh"
+
+int main() {{
+  using namespace ad::literals;
+  [[maybe_unused]] constexpr auto x = ad::_0;
+  [[maybe_unused]] constexpr auto y = ad::_1;
+  [[maybe_unused]] constexpr auto z = ad::_2;
+  const auto f = {expression};
+  const auto d = f.derive({variables});
+  const auto e = f.derive({reversed});
+  return static_cast<int>(d(0.5, 1.5, 2.5) + e(0.5, 1.5, 2.5));
+}}
+"""
+
+
+def measure(command):
+    """Runs `command` and returns its wall time, CPU time and peak memory."""
+    start = time.perf_counter()
+    process = subprocess.Popen(command)
+    _, status, usage = os.wait4(process.pid, 0)
+    wall = time.perf_counter() - start
+    if os.waitstatus_to_exitcode(status) != 0:
+        sys.exit(f"compilation failed: {' '.join(command)}")
+    cpu = usage.ru_utime + usage.ru_stime
+    # ru_maxrss is in bytes on macOS and in kilobytes elsewhere
+    kb = usage.ru_maxrss // 1024 if sys.platform == "darwin" else usage.ru_maxrss
+    return wall, cpu, kb
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--compiler", default=os.environ.get("CXX", "c++"))
+    parser.add_argument("--include", required=True)
+    parser.add_argument("--std", default="c++17")
+    parser.add_argument("--max-order", type=int, default=6)
+    parser.add_argument("--shape", action="append", choices=sorted(SHAPES))
+    args = parser.parse_args()
+
+    print("shape,order,wall_seconds,cpu_seconds,max_rss_kb", flush=True)
+    with tempfile.TemporaryDirectory() as directory:
+        for shape in args.shape or SHAPES:
+            expression, variables = SHAPES[shape]
+            for order in range(1, args.max_order + 1):
+                derive = [variables[k % len(variables)] for k in range(order)]
+                path = os.path.join(directory, f"{shape}_{order}.cc")
+                with open(path, "w") as source:
+                    source.write(
+                        SOURCE.format(
+                            expression=expression,
+                            variables=", ".join(derive),
+                            reversed=", ".join(reversed(derive)),
+                        )
+                    )
+                command = [
+                    args.compiler,
+                    f"-std={args.std}",
+                    "-fsyntax-only",
+                    "-I",
+                    args.include,
+                    path,
+                ]
+                wall, cpu, kb = measure(command)
+                print(f"{shape},{order},{wall:.3f},{cpu:.3f},{kb}", flush=True)
+
+
+if __name__ == "__main__":
+    main()
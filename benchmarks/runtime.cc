@@ -0,0 +1,468 @@
+#include "benchmark.hh"
+
+#include "ad/ad.hh"
+#include "ad/batch.hh"
+#include "ad/cse.hh"
+#include "ad/dual.hh"
+#include "ad/fast_math.hh"
+#include "ad/function.hh"
+#include "ad/minimize.hh"
+#include "ad/newton.hh"
+#include "ad/reverse.hh"
+#include "ad/solve.hh"
+#include "ad/taylor.hh"
+
+#include <array>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+#include <utility>
+
+// Measures the evaluation of expressions against equivalent handwritten code.
+// Pass a substring of a benchmark name to run only the matching benchmarks.
+
+namespace {
+using namespace ad::literals;
+constexpr auto x = ad::_0;
+
+void polynomial(bench::report& report) {
+  const auto f = 3_c * x * x * x - 2_c * x * x + x - 5_c;
+  report.add("polynomial", "handwritten", [](std::size_t i) {
+    const double t = bench::input(i);
+    return 3 * t * t * t - 2 * t * t + t - 5;
+  });
+  report.add("polynomial", "ad", [&](std::size_t i) {
+    return f(bench::input(i));
+  });
+}
+
+// Third derivative of a polynomial given as a product
+void polynomial_derivative(bench::report& report) {
+  const auto f   = (x + 1_c) * (x - 1_c) * (x * x + 2_c) * (x - 3_c);
+  const auto d3f = f.derive().derive().derive();
+  report.add("polynomial_derivative", "handwritten", [](std::size_t i) {
+    const double t = bench::input(i);
+    return (60 * t - 72) * t + 6;
+  });
+  report.add("polynomial_derivative", "ad", [&](std::size_t i) {
+    return d3f(bench::input(i));
+  });
+}
+
+void powers(bench::report& report) {
+  const auto f = ad::pow(x, 4_c) + ad::pow(x, -3_c) + ad::pow(x, 3_c / 2_c);
+  report.add("powers", "handwritten", [](std::size_t i) {
+    const double t      = bench::input(i);
+    const double square = t * t;
+    return square * square + 1 / (square * t) + t * std::sqrt(t);
+  });
+  report.add("powers", "ad", [&](std::size_t i) {
+    return f(bench::input(i));
+  });
+}
+
+void transcendental(bench::report& report) {
+  const auto f = ad::exp(ad::sin(x)) * ad::log(1_c + x * x)
+               + ad::sqrt(ad::cosh(x));
+  report.add("transcendental", "handwritten", [](std::size_t i) {
+    const double t = bench::input(i);
+    return std::exp(std::sin(t)) * std::log(1 + t * t)
+           + std::sqrt(std::cosh(t));
+  });
+  report.add("transcendental", "ad", [&](std::size_t i) {
+    return f(bench::input(i));
+  });
+  report.add("transcendental", "ad_fast", [&](std::size_t i) {
+    return f(ad::fast(bench::input(i))).value;
+  });
+}
+
+// The same function evaluated at 1024 points per call
+void transcendental_batch(bench::report& report) {
+  const auto f = ad::exp(ad::sin(x)) * ad::log(1_c + x * x)
+               + ad::sqrt(ad::cosh(x));
+  constexpr std::size_t n = 1024;
+  std::vector<double> xs(n);
+  std::vector<double> out(n);
+  std::vector<ad::fast<double>> fast_xs(n);
+  std::vector<ad::fast<double>> fast_out(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    xs[i]      = bench::input(i);
+    fast_xs[i] = xs[i];
+  }
+  report.add("transcendental_batch", "handwritten", [&](std::size_t i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      const double t = xs[j];
+      out[j]         = std::exp(std::sin(t)) * std::log(1 + t * t)
+             + std::sqrt(std::cosh(t));
+    }
+    return out[i % n];
+  });
+  report.add("transcendental_batch", "ad", [&](std::size_t i) {
+    ad::eval(f, xs, out);
+    return out[i % n];
+  });
+  report.add("transcendental_batch", "ad_fast", [&](std::size_t i) {
+    ad::eval(f, fast_xs, fast_out);
+    return fast_out[i % n].value;
+  });
+}
+
+// One of several formulas chosen at runtime and evaluated at 256 points per
+// call
+void dispatch(bench::report& report) {
+  constexpr auto y        = ad::_1;
+  constexpr std::size_t n = 256;
+  std::vector<double> xs(n);
+  std::vector<double> ys(n);
+  std::vector<double> out(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    xs[i] = bench::input(i);
+    ys[i] = bench::input(i, 1.3);
+  }
+  const std::vector<std::function<double(double, double)>> std_functions{
+      [](double s, double t) { return s * t + 1; },
+      [](double s, double t) { return s * s - t; },
+      [](double s, double t) { return s / (t + 2); },
+  };
+  const std::vector<ad::function<2>> ad_functions{
+      x * y + 1_c, x * x - y, x / (y + 2_c)};
+  report.add("dispatch", "std_function", [&](std::size_t i) {
+    const auto& f = std_functions[i % 3];
+    for (std::size_t j = 0; j < n; ++j) {
+      out[j] = f(xs[j], ys[j]);
+    }
+    return out[i % n];
+  });
+  report.add("dispatch", "ad_function", [&](std::size_t i) {
+    ad_functions[i % 3].eval(xs, ys, out);
+    return out[i % n];
+  });
+}
+
+// Roots of `x e^x - p`, i.e. Lambert's W function, for 1024 parameters `p` per
+// call
+void newton(bench::report& report) {
+  constexpr auto p        = ad::_1;
+  constexpr std::size_t n = 1024;
+  const auto f            = x * ad::exp(x) - p;
+  const auto df           = f.derive();
+  std::vector<double> starts(n, 1.0);
+  std::vector<double> ps(n);
+  std::vector<double> roots(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    ps[i] = 10 * bench::input(i);
+  }
+  // Iterates like `ad::find_roots` but one root at a time
+  const auto scalar = [&](auto value, auto derivative) {
+    for (std::size_t i = 0; i < n; ++i) {
+      double t = starts[i];
+      for (std::size_t k = 0; k < 50; ++k) {
+        const double step = value(t, ps[i]) / derivative(t, ps[i]);
+        t -= step;
+        if (std::abs(step) <= 1e-12 * std::max(1.0, std::abs(t))) {
+          break;
+        }
+      }
+      roots[i] = t;
+    }
+  };
+  report.add("newton", "handwritten", [&](std::size_t i) {
+    scalar(
+        [](double t, double c) { return t * std::exp(t) - c; },
+        [](double t, double) { return (t + 1) * std::exp(t); }
+    );
+    return roots[i % n];
+  });
+  report.add("newton", "ad_scalar", [&](std::size_t i) {
+    scalar(f, df);
+    return roots[i % n];
+  });
+  report.add("newton", "ad_find_roots", [&](std::size_t i) {
+    ad::newton_options options;
+    options.threads = 1;
+    ad::find_roots(f, starts, ps, roots, options);
+    return roots[i % n];
+  });
+}
+
+// Intersection of a circle and an exponential by Newton's method
+void solve(bench::report& report) {
+  constexpr auto y = ad::_1;
+  const auto fs    = ad::make_vector(x * x + y * y - 4_c, ad::exp(x) + y - 1_c);
+  report.add("solve", "handwritten", [](std::size_t i) {
+    double s = 1.0 + 0.1 * bench::input(i);
+    double t = -1.0;
+    for (int k = 0; k < 100; ++k) {
+      const double e  = std::exp(s);
+      const double f  = s * s + t * t - 4;
+      const double g  = e + t - 1;
+      const double d  = 2 * s - 2 * t * e;
+      const double ds = (f - 2 * t * g) / d;
+      const double dt = (2 * s * g - e * f) / d;
+      s -= ds;
+      t -= dt;
+      if (std::max(std::abs(ds), std::abs(dt))
+          <= 1e-12 * std::max({1.0, std::abs(s), std::abs(t)})) {
+        break;
+      }
+    }
+    return s + t;
+  });
+  report.add("solve", "ad", [&](std::size_t i) {
+    std::array<double, 2> xs{1.0 + 0.1 * bench::input(i), -1.0};
+    ad::solve(fs, xs);
+    return xs[0] + xs[1];
+  });
+}
+
+// Minimum of the Rosenbrock function. The handwritten baseline takes Newton
+// steps with analytic derivatives, shifting the Hessian until it is positive
+// definite and backtracking until the value decreases.
+void minimize(bench::report& report) {
+  constexpr auto y = ad::_1;
+  const auto f = 100_c * ad::pow(y - x * x, 2_c) + ad::pow(1_c - x, 2_c);
+  report.add("minimize", "handwritten", [](std::size_t i) {
+    const auto value = [](double s, double t) {
+      return 100 * (t - s * s) * (t - s * s) + (1 - s) * (1 - s);
+    };
+    double s = -1.2 + 0.1 * bench::input(i);
+    double t = 1.0;
+    for (int k = 0; k < 200; ++k) {
+      const double r  = t - s * s;
+      const double gs = -400 * s * r - 2 * (1 - s);
+      const double gt = 200 * r;
+      if (std::max(std::abs(gs), std::abs(gt)) <= 1e-10) {
+        break;
+      }
+      double hss = 1200 * s * s - 400 * t + 2;
+      double htt = 200;
+      const double hst = -400 * s;
+      for (double mu = 1e-3; hss <= 0 || hss * htt - hst * hst <= 0; mu *= 10) {
+        hss += mu;
+        htt += mu;
+      }
+      const double d  = hss * htt - hst * hst;
+      const double ds = -(htt * gs - hst * gt) / d;
+      const double dt = -(hss * gt - hst * gs) / d;
+      const double f0 = value(s, t);
+      double a        = 1;
+      while (value(s + a * ds, t + a * dt) > f0 + 1e-4 * a * (gs * ds + gt * dt)
+             && a > 1e-10) {
+        a /= 2;
+      }
+      s += a * ds;
+      t += a * dt;
+    }
+    return s + t;
+  });
+  report.add("minimize", "ad_newton", [&](std::size_t i) {
+    std::array<double, 2> xs{-1.2 + 0.1 * bench::input(i), 1.0};
+    ad::minimize_newton(f, xs);
+    return xs[0] + xs[1];
+  });
+  report.add("minimize", "ad_lbfgs", [&](std::size_t i) {
+    std::array<double, 2> xs{-1.2 + 0.1 * bench::input(i), 1.0};
+    ad::minimize_lbfgs(f, xs);
+    return xs[0] + xs[1];
+  });
+}
+
+// Derivative of functions whose derivatives evaluate `sinh` and `cosh` or
+// `exp(x)` and `exp(-x)` of the same argument
+void hyperbolic(bench::report& report) {
+  const auto f  = ad::sinh(x) * ad::cosh(x) + ad::exp(x) - ad::exp(-x);
+  const auto df = f.derive();
+  report.add("hyperbolic", "handwritten", [](std::size_t i) {
+    const double t = bench::input(i);
+    const double s = std::sinh(t);
+    const double c = std::cosh(t);
+    return c * c + s * s + std::exp(t) + std::exp(-t);
+  });
+  report.add("hyperbolic", "ad", [&](std::size_t i) {
+    return df(bench::input(i));
+  });
+  report.add("hyperbolic", "ad_cse", [&](std::size_t i) {
+    return ad::cse(df)(bench::input(i));
+  });
+}
+
+// Second derivative of functions whose derivatives divide by square roots
+void inverse(bench::report& report) {
+  const auto f   = ad::asin(x) + ad::asinh(x / 2.0) + x * x / 3_c;
+  const auto d2f = f.derive().derive();
+  report.add("inverse", "handwritten", [](std::size_t i) {
+    const double t = bench::input(i);
+    const double u = 1 - t * t;
+    const double v = 1 + t * t / 4;
+    return t / (u * std::sqrt(u)) - t / (8 * v * std::sqrt(v)) + 2.0 / 3;
+  });
+  report.add("inverse", "ad", [&](std::size_t i) {
+    return d2f(bench::input(i));
+  });
+}
+
+// Derivatives of a power with constant base contain the logarithm of the base
+void exponential_base(bench::report& report) {
+  const double a  = 1.0 + bench::input(0);
+  const auto d2f  = ad::pow(a, x).derive().derive();
+  const double la = std::log(a);
+  report.add("exponential_base", "handwritten", [=](std::size_t i) {
+    return std::pow(a, bench::input(i)) * la * la;
+  });
+  report.add("exponential_base", "ad", [&](std::size_t i) {
+    return d2f(bench::input(i));
+  });
+}
+
+// Derivatives of `sin(x) exp(x)`
+template <
+    std::size_t K,
+    typename Handwritten,
+    typename Symbolic,
+    typename Canonical>
+void derivative(
+    bench::report& report,
+    Handwritten handwritten,
+    Symbolic symbolic,
+    Canonical canonical
+) {
+  const std::string name = "derivative_" + std::to_string(K);
+  const auto f           = ad::sin(x) * ad::exp(x);
+  report.add(name, "handwritten", [&](std::size_t i) {
+    return handwritten(bench::input(i));
+  });
+  report.add(name, "ad_symbolic", [&](std::size_t i) {
+    return symbolic(bench::input(i));
+  });
+  report.add(name, "ad_canonical", [&](std::size_t i) {
+    return canonical(bench::input(i));
+  });
+  report.add(name, "ad_taylor", [&](std::size_t i) {
+    return ad::derivative<K>(f, bench::input(i));
+  });
+}
+
+void derivatives(bench::report& report) {
+  const auto f   = ad::sin(x) * ad::exp(x);
+  const auto df  = f.derive();
+  const auto d2f = df.derive();
+  const auto d3f = d2f.derive();
+  const auto d4f = d3f.derive();
+  derivative<1>(
+      report,
+      [](double t) { return std::exp(t) * (std::sin(t) + std::cos(t)); },
+      df,
+      ad::canonicalize(df)
+  );
+  derivative<2>(
+      report,
+      [](double t) { return 2 * std::exp(t) * std::cos(t); },
+      d2f,
+      f.derive(x, x)
+  );
+  derivative<3>(
+      report,
+      [](double t) { return 2 * std::exp(t) * (std::cos(t) - std::sin(t)); },
+      d3f,
+      f.derive(x, x, x)
+  );
+  derivative<4>(
+      report,
+      [](double t) { return -4 * std::exp(t) * std::sin(t); },
+      d4f,
+      f.derive(x, x, x, x)
+  );
+}
+
+// `sum_i sin(x_i) x_{i + 1}` with cyclic indices
+template <std::size_t... Is>
+constexpr auto ring(std::index_sequence<Is...>) noexcept {
+  constexpr std::size_t n = sizeof...(Is);
+  return (... + (ad::sin(ad::variable<Is>()) * ad::variable<(Is + 1) % n>()));
+}
+
+template <std::size_t N>
+std::array<double, N> ring_gradient(const std::array<double, N>& xs) noexcept {
+  std::array<double, N> gradient{};
+  for (std::size_t i = 0; i < N; ++i) {
+    gradient[i] = std::cos(xs[i]) * xs[(i + 1) % N]
+                + std::sin(xs[(i + N - 1) % N]);
+  }
+  return gradient;
+}
+
+template <std::size_t... Is>
+void evaluation(bench::report& report, std::index_sequence<Is...> is) {
+  constexpr std::size_t n = sizeof...(Is);
+  const std::string name  = "evaluation_" + std::to_string(n);
+  const auto f            = ring(is);
+  const auto inputs       = [](std::size_t i) {
+    return std::array<double, n>{bench::input(i, 0.3 + 0.1 * Is)...};
+  };
+  report.add(name, "handwritten", [&](std::size_t i) {
+    const auto xs = inputs(i);
+    double result = 0;
+    for (std::size_t j = 0; j < n; ++j) {
+      result += std::sin(xs[j]) * xs[(j + 1) % n];
+    }
+    return result;
+  });
+  report.add(name, "ad_arguments", [&](std::size_t i) {
+    const auto xs = inputs(i);
+    return f(xs[Is]...);
+  });
+  report.add(name, "ad_context", [&](std::size_t i) {
+    return ad::evaluate(f, inputs(i));
+  });
+}
+
+template <std::size_t... Is>
+void gradient(bench::report& report, std::index_sequence<Is...> is) {
+  constexpr std::size_t n = sizeof...(Is);
+  const std::string name  = "gradient_" + std::to_string(n);
+  const auto f            = ring(is);
+  const auto inputs       = [](std::size_t i) {
+    return std::array<double, n>{bench::input(i, 0.3 + 0.1 * Is)...};
+  };
+  report.add(name, "handwritten", [&](std::size_t i) {
+    return ring_gradient(inputs(i));
+  });
+  report.add(name, "ad_symbolic", [&](std::size_t i) {
+    const auto xs = inputs(i);
+    return std::array<double, n>{
+        f.derive(ad::variable<Is>())(xs[Is]...)...};
+  });
+  report.add(name, "ad_forward", [&](std::size_t i) {
+    const auto xs = inputs(i);
+    return ad::value_and_gradient(f, xs[Is]...);
+  });
+  report.add(name, "ad_reverse", [&](std::size_t i) {
+    const auto xs = inputs(i);
+    return ad::value_and_gradient(ad::reverse_mode, f, xs[Is]...);
+  });
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  bench::report report(argc > 1 ? argv[1] : "");
+  polynomial(report);
+  polynomial_derivative(report);
+  powers(report);
+  transcendental(report);
+  transcendental_batch(report);
+  dispatch(report);
+  newton(report);
+  solve(report);
+  minimize(report);
+  hyperbolic(report);
+  inverse(report);
+  exponential_base(report);
+  derivatives(report);
+  evaluation(report, std::make_index_sequence<10>{});
+  evaluation(report, std::make_index_sequence<40>{});
+  gradient(report, std::make_index_sequence<2>{});
+  gradient(report, std::make_index_sequence<4>{});
+  gradient(report, std::make_index_sequence<10>{});
+}
@@ -1,6 +1,8 @@
 #include "ad/ad.hh"
+#include "ad/newton.hh"
 
 #include <iostream>
+#include <vector>
 
 // Find root using Newton method https://en.wikipedia.org/wiki/Newton%27s_method
 
@@ -24,4 +26,14 @@ int main() {
 
   const auto g = ad::cos(x);
   std::cout << 2 * find_root(g) << '\n';
+
+  // Many roots at once: the square roots of 1 to 4
+  const auto p = ad::_1;
+  const std::vector<double> starts(4, 1.0);
+  const std::vector<double> ps{1.0, 2.0, 3.0, 4.0};
+  std::vector<double> roots(4);
+  ad::find_roots(x * x - p, starts, ps, roots);
+  for (double root : roots) {
+    std::cout << root << '\n';
+  }
 }
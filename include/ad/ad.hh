@@ -1,7 +1,14 @@
 #ifndef AUTOMATICDIFFERENTIATION_AD_HH_1574234361739842350_
 #define AUTOMATICDIFFERENTIATION_AD_HH_1574234361739842350_
 
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 
 #include <cmath>
 
@@ -11,11 +18,110 @@
 #  define AD_NO_UNIQUE_ADDRESS
 #endif
 
+// Sums and differences with a product operand are evaluated with `std::fma` if
+// `AD_FMA` is nonzero. By default only on targets with fast hardware FMA, since
+// `std::fma` is a slow library call otherwise.
+#if !defined(AD_FMA)
+#  if defined(FP_FAST_FMA)
+#    define AD_FMA 1
+#  else
+#    define AD_FMA 0
+#  endif
+#endif
+
 namespace ad {
+// Customization point for the functions used while evaluating an expression
+// with scalars of type `T`. By default the functions are looked up in `std` and
+// via ADL. Specialize it for scalar types that need a different implementation.
+template <typename T>
+struct math {
+  static constexpr T exp(T x) noexcept {
+    using std::exp;
+    return exp(x);
+  }
+
+  static constexpr T log(T x) noexcept {
+    using std::log;
+    return log(x);
+  }
+
+  static constexpr T sqrt(T x) noexcept {
+    using std::sqrt;
+    return sqrt(x);
+  }
+
+  static constexpr T sin(T x) noexcept {
+    using std::sin;
+    return sin(x);
+  }
+
+  static constexpr T cos(T x) noexcept {
+    using std::cos;
+    return cos(x);
+  }
+
+  static constexpr T tan(T x) noexcept {
+    using std::tan;
+    return tan(x);
+  }
+
+  static constexpr T sinh(T x) noexcept {
+    using std::sinh;
+    return sinh(x);
+  }
+
+  static constexpr T cosh(T x) noexcept {
+    using std::cosh;
+    return cosh(x);
+  }
+
+  static constexpr T tanh(T x) noexcept {
+    using std::tanh;
+    return tanh(x);
+  }
+
+  static constexpr T asin(T x) noexcept {
+    using std::asin;
+    return asin(x);
+  }
+
+  static constexpr T acos(T x) noexcept {
+    using std::acos;
+    return acos(x);
+  }
+
+  static constexpr T atan(T x) noexcept {
+    using std::atan;
+    return atan(x);
+  }
+
+  static constexpr T asinh(T x) noexcept {
+    using std::asinh;
+    return asinh(x);
+  }
+
+  static constexpr T acosh(T x) noexcept {
+    using std::acosh;
+    return acosh(x);
+  }
+
+  static constexpr T atanh(T x) noexcept {
+    using std::atanh;
+    return atanh(x);
+  }
+
+  static constexpr T pow(T x, T y) noexcept {
+    using std::pow;
+    return pow(x, y);
+  }
+};
+
 namespace detail {
 template <std::size_t N>
 struct variable;
 struct runtime_constant;
+template <typename E>
+struct constant_function;
 template <typename L, typename R>
 struct addition;
 template <typename L, typename R>
@@ -71,6 +177,66 @@ inline constexpr bool is_static_v = false;
 template <typename T>
 struct is_variable : std::bool_constant<is_variable_v<T>> {};
 
+// Indices of a mixed derivative in ascending order. Partial derivatives
+// commute, so sorting lets `derive(x, y)` and `derive(y, x)` share a type.
+template <std::size_t... Is>
+struct sorted_indices {
+  static constexpr std::array<std::size_t, sizeof...(Is)> values = [] {
+    std::array<std::size_t, sizeof...(Is)> result{Is...};
+    for (std::size_t i = 1; i < result.size(); ++i) {
+      for (std::size_t j = i; j > 0 && result[j] < result[j - 1]; --j) {
+        const std::size_t tmp = result[j];
+        result[j]             = result[j - 1];
+        result[j - 1]         = tmp;
+      }
+    }
+    return result;
+  }();
+
+  template <std::size_t... Js>
+  static auto sort(std::index_sequence<Js...>)
+      -> std::index_sequence<values[Js]...>;
+
+  using type = decltype(sort(std::make_index_sequence<sizeof...(Is)>{}));
+};
+
+template <typename E>
+constexpr auto canonicalize(const E& expr) noexcept;
+
+template <typename E>
+constexpr auto polynomial_form(const E& expr) noexcept;
+
+// Takes the derivatives with respect to `Is` one after another and brings the
+// result into canonical form. Every step is a separate class template
+// instantiation, so the compiler memoizes the intermediate derivative types and
+// higher orders reuse the lower ones.
+template <typename E, typename Indices>
+struct derivative;
+
+template <typename E>
+struct derivative<E, std::index_sequence<>> {
+  using type = decltype(canonicalize(std::declval<const E&>()));
+
+  static constexpr type apply(const E& expr) noexcept {
+    return canonicalize(expr);
+  }
+};
+
+template <typename E, std::size_t I, std::size_t... Is>
+struct derivative<E, std::index_sequence<I, Is...>> {
+  using first = decltype(std::declval<const E&>().template derive<I>());
+  using rest  = derivative<first, std::index_sequence<Is...>>;
+  using type  = typename rest::type;
+
+  static constexpr type apply(const E& expr) noexcept {
+    return rest::apply(expr.template derive<I>());
+  }
+};
+
+template <typename E, std::size_t... Is>
+using derivative_t =
+    typename derivative<E, typename sorted_indices<Is...>::type>::type;
+
 template <typename ConcreteExpression>
 struct expression {
   template <
@@ -79,23 +245,6 @@ struct expression {
   constexpr auto derive(Ts...) const noexcept {
     return derive<Ts::value...>();
   }
-#if __clang__
-  // workaround for
-  // https://www.reddit.com/r/cpp_questions/comments/ev4657/possible_bug_in_clangs_template_lookup/
-  template <std::size_t I, std::size_t... Is>
-  constexpr auto derive_helper() const noexcept {
-    const auto& expr = static_cast<const ConcreteExpression&>(*this);
-    if constexpr (sizeof...(Is) == 1) {
-      return expr               //
-          .template derive<I>() //
-          .template derive<Is...>();
-    }
-    else {
-      return expr               //
-          .template derive<I>() //
-          .template derive_helper<Is...>();
-    }
-  }
 
   template <std::size_t I, std::size_t... Is>
   constexpr auto derive() const noexcept {
@@ -103,31 +252,11 @@ struct expression {
     if constexpr (sizeof...(Is) == 0) {
       return expr.template derive<I>();
     }
-    else if constexpr (sizeof...(Is) == 1) {
-      return expr               //
-          .template derive<I>() //
-          .template derive<Is...>();
-    }
-    else {
-      return expr               //
-          .template derive<I>() //
-          .template derive_helper<Is...>();
-    }
-  }
-#else
-  template <std::size_t I, std::size_t... Is>
-  constexpr auto derive() const noexcept {
-    const auto& expr = static_cast<const ConcreteExpression&>(*this);
-    if constexpr (sizeof...(Is) > 0) {
-      return expr               //
-          .template derive<I>() //
-          .template derive<Is...>();
-    }
     else {
-      return expr.template derive<I>();
+      using indices = typename sorted_indices<I, Is...>::type;
+      return derivative<ConcreteExpression, indices>::apply(expr);
     }
   }
-#endif
 
 private:
   constexpr expression() = default;
@@ -156,19 +285,45 @@ inline constexpr bool is_expression_v = std::is_base_of_v<expression<T>, T>
 
 // clang-format on
 
-template <long N>
-struct static_constant : expression<static_constant<N>> {
+template <typename T>
+struct is_argument : std::bool_constant<!is_expression_v<T>> {};
+
+template <typename... Ts>
+struct common_scalar : std::common_type<Ts...> {};
+
+template <>
+struct common_scalar<> {
+  using type = double;
+};
+
+// Scalar type an expression is evaluated in. Integral arguments are promoted to
+// `double`.
+template <typename... Ts>
+using scalar_t = std::conditional_t<
+    std::is_integral_v<typename common_scalar<Ts...>::type>,
+    double,
+    typename common_scalar<Ts...>::type>;
+
+// Exact rational constant `N / D` in lowest terms with `D > 0`
+template <long N, long D = 1>
+struct static_constant : expression<static_constant<N, D>> {
+  static_assert(D > 0 && std::gcd(N, D) == 1);
+
   using expression<static_constant>::derive;
+  inline static constexpr long numerator   = N;
+  inline static constexpr long denominator = D;
+
   constexpr static_constant() = default;
 
-  constexpr double value() const noexcept { return static_cast<double>(N); }
+  constexpr double value() const noexcept {
+    return static_cast<double>(N) / static_cast<double>(D);
+  }
 
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts...) const noexcept {
-    return value();
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts...) const noexcept {
+    return static_cast<scalar_t<Ts...>>(value());
   }
 
   template <std::size_t = 0>
@@ -177,11 +332,11 @@ struct static_constant : expression<static_constant<N>> {
   }
 };
 
-template <long N>
-inline constexpr bool is_constant_v<static_constant<N>> = true;
+template <long N, long D>
+inline constexpr bool is_constant_v<static_constant<N, D>> = true;
 
-template <long N>
-inline constexpr bool is_static_v<static_constant<N>> = true;
+template <long N, long D>
+inline constexpr bool is_static_v<static_constant<N, D>> = true;
 
 template <typename T>
 inline constexpr bool is_static_constant_v = is_constant_v<T> && is_static_v<T>;
@@ -189,6 +344,26 @@ inline constexpr bool is_static_constant_v = is_constant_v<T> && is_static_v<T>;
 using zero  = static_constant<0>;
 using unity = static_constant<1>;
 
+constexpr long integral_power(long c, long k) noexcept {
+  long result = 1;
+  for (; k > 0; --k) {
+    result *= c;
+  }
+  return result;
+}
+
+// Returns `N / D` in lowest terms
+template <long N, long D>
+using rational_t = static_constant<
+    (D < 0 ? -N : N) / std::gcd(N, D),
+    (D < 0 ? -D : D) / std::gcd(N, D)>;
+
+template <typename T>
+inline constexpr bool is_integral_constant_v = false;
+
+template <long N>
+inline constexpr bool is_integral_constant_v<static_constant<N>> = true;
+
 struct runtime_constant : expression<runtime_constant> {
   using expression<runtime_constant>::derive;
   double _value;
@@ -199,10 +374,9 @@ struct runtime_constant : expression<runtime_constant> {
 
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts...) const noexcept {
-    return _value;
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts...) const noexcept {
+    return static_cast<scalar_t<Ts...>>(_value);
   }
 
   template <std::size_t = 0>
@@ -214,6 +388,69 @@ struct runtime_constant : expression<runtime_constant> {
 template <>
 inline constexpr bool is_constant_v<runtime_constant> = true;
 
+// Returns true during constant evaluation, and conservatively also without
+// support of the compiler
+constexpr bool is_constant_evaluated() noexcept {
+#if defined(__cpp_lib_is_constant_evaluated)
+  return std::is_constant_evaluated();
+#elif defined(__has_builtin)
+#  if __has_builtin(__builtin_is_constant_evaluated)
+  return __builtin_is_constant_evaluated();
+#  else
+  return true;
+#  endif
+#elif defined(_MSC_VER) && _MSC_VER >= 1925
+  return __builtin_is_constant_evaluated();
+#else
+  return true;
+#endif
+}
+
+// Function `E` of constant operands like `exp(1_c)`, whose value is computed
+// once when it is built. The functions of the standard library cannot be
+// called in constant expressions, so an expression built during constant
+// evaluation computes the value on every evaluation instead.
+template <typename E>
+struct constant_function : expression<constant_function<E>> {
+  using expression<constant_function<E>>::derive;
+  E expr;
+  double _value = 0;
+  bool _folded  = false;
+
+  constexpr explicit constant_function(E e) noexcept : expr(e) {
+    if (!is_constant_evaluated()) {
+      _value  = static_cast<double>(expr());
+      _folded = true;
+    }
+  }
+
+  constexpr double value() const noexcept {
+    return _folded ? _value : static_cast<double>(expr());
+  }
+
+  template <
+      typename... Ts,
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts...) const noexcept {
+    return static_cast<scalar_t<Ts...>>(value());
+  }
+
+  template <std::size_t = 0>
+  constexpr auto derive() const noexcept {
+    return zero{};
+  }
+};
+
+template <typename E>
+inline constexpr bool is_constant_v<constant_function<E>> = true;
+
+// Constants whose `value()` is usable in constant expressions
+template <typename T>
+inline constexpr bool is_literal_constant_v = is_constant_v<T>;
+
+template <typename E>
+inline constexpr bool is_literal_constant_v<constant_function<E>> = false;
+
 template <typename...>
 inline constexpr bool dependent_false = false;
 
@@ -232,8 +469,22 @@ constexpr auto as_expression(T x) noexcept {
   }
 }
 
+// Arguments stored once in contiguous memory. Nodes pass it on to their
+// operands instead of the whole argument pack and variables index it directly.
+template <typename S>
+struct context {
+  const S* values;
+
+  constexpr S operator[](std::size_t i) const noexcept { return values[i]; }
+};
+
+template <typename S>
+struct common_scalar<context<S>> {
+  using type = S;
+};
+
 template <std::size_t I, typename... Ts>
-constexpr double get_argument(Ts... xs) noexcept {
+constexpr auto get_argument(Ts... xs) noexcept {
   if constexpr (I >= sizeof...(Ts)) {
     static_assert(
         dependent_false<Ts...>,
@@ -242,7 +493,7 @@ constexpr double get_argument(Ts... xs) noexcept {
     );
   }
   else {
-    double arguments[] = {static_cast<double>(xs)...};
+    scalar_t<Ts...> arguments[] = {static_cast<scalar_t<Ts...>>(xs)...};
     return arguments[I];
   }
 }
@@ -253,12 +504,16 @@ struct variable : expression<variable<N>> {
 
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
     return get_argument<N>(xs...);
   }
 
+  template <typename S>
+  constexpr auto operator()(context<S> xs) const noexcept {
+    return static_cast<scalar_t<context<S>>>(xs[N]);
+  }
+
   template <std::size_t I = 0>
   constexpr auto derive() const noexcept {
     if constexpr (I == N) {
@@ -281,9 +536,64 @@ inline constexpr bool is_static_v<variable<N>> = true;
 template <template <typename> typename E, typename T>
 inline constexpr bool is_static_v<E<T>> = is_static_v<T>;
 
+template <typename E>
+inline constexpr bool is_static_v<constant_function<E>> = false;
+
 template <typename T>
 struct is_static : std::bool_constant<is_static_v<T>> {};
 
+template <typename T>
+inline constexpr bool is_unary_v = false;
+
+template <template <typename> typename E, typename T>
+inline constexpr bool is_unary_v<E<T>> = true;
+
+template <typename E>
+inline constexpr bool is_unary_v<constant_function<E>> = false;
+
+template <typename T>
+inline constexpr bool is_binary_v = false;
+
+template <template <typename, typename> typename E, typename L, typename R>
+inline constexpr bool is_binary_v<E<L, R>> = true;
+
+// Type of the `I`th operand of a unary or binary expression
+template <typename E, std::size_t I>
+struct operand;
+
+template <template <typename> typename E, typename T>
+struct operand<E<T>, 0> {
+  using type = T;
+};
+
+template <template <typename, typename> typename E, typename L, typename R>
+struct operand<E<L, R>, 0> {
+  using type = L;
+};
+
+template <template <typename, typename> typename E, typename L, typename R>
+struct operand<E<L, R>, 1> {
+  using type = R;
+};
+
+template <typename E, std::size_t I>
+using operand_t = typename operand<E, I>::type;
+
+// Number of arguments needed to evaluate `E`, i.e. one more than its largest
+// variable index
+template <typename E>
+inline constexpr std::size_t arity_v = 0;
+
+template <std::size_t N>
+inline constexpr std::size_t arity_v<variable<N>> = N + 1;
+
+template <template <typename> typename E, typename T>
+inline constexpr std::size_t arity_v<E<T>> = arity_v<T>;
+
+template <template <typename, typename> typename E, typename L, typename R>
+inline constexpr std::size_t arity_v<E<L, R>> =
+    std::max(arity_v<L>, arity_v<R>);
+
 template <template <typename, typename> typename E, typename L, typename R>
 inline constexpr bool is_static_v<E<L, R>> =
     std::conjunction_v<is_static<L>, is_static<R>>;
@@ -294,9 +604,31 @@ template <typename L, typename R>
 inline constexpr bool is_static_same_v =
     std::conjunction_v<std::is_same<L, R>, is_static<L>, is_static<R>>;
 
+// Functions of constant operands are evaluated once when the expression is
+// built instead of on every evaluation
+template <template <typename> typename E, typename T>
+constexpr auto fold_constant(E<T> expr) noexcept {
+  if constexpr (is_constant_v<T>) {
+    return constant_function{expr};
+  }
+  else {
+    return expr;
+  }
+}
+
+template <template <typename, typename> typename E, typename L, typename R>
+constexpr auto fold_constant(E<L, R> expr) noexcept {
+  if constexpr (is_constant_v<L> && is_constant_v<R>) {
+    return constant_function{expr};
+  }
+  else {
+    return expr;
+  }
+}
+
 template <typename T>
 constexpr auto exp(T x) noexcept {
-  return exponential(as_expression(x));
+  return fold_constant(exponential(as_expression(x)));
 }
 
 template <typename T>
@@ -312,12 +644,16 @@ struct exponential : unary_function<exponential<T>> {
 
   constexpr explicit exponential(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return math<S>::exp(x);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::exp(arg(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
 private:
@@ -326,7 +662,7 @@ private:
 
 template <typename T>
 constexpr auto sqrt(T x) noexcept {
-  return square_root(as_expression(x));
+  return fold_constant(square_root(as_expression(x)));
 }
 
 template <typename T>
@@ -337,23 +673,27 @@ struct square_root : unary_function<square_root<T>> {
 
   constexpr explicit square_root(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return math<S>::sqrt(x);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::sqrt(arg(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
 private:
   constexpr auto derive_outer() const noexcept {
-    return unity{} / (static_constant<2>{} * *this);
+    return static_constant<1, 2>{} / *this;
   }
 };
 
 template <typename T>
 constexpr auto log(T x) noexcept {
-  return logarithm(as_expression(x));
+  return fold_constant(logarithm(as_expression(x)));
 }
 
 template <typename T>
@@ -369,12 +709,16 @@ struct logarithm : unary_function<logarithm<T>> {
 
   constexpr explicit logarithm(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return math<S>::log(x);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::log(arg(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
 private:
@@ -383,7 +727,7 @@ private:
 
 template <typename T>
 constexpr auto sin(T x) noexcept {
-  return sinus(as_expression(x));
+  return fold_constant(sinus(as_expression(x)));
 }
 
 template <typename T>
@@ -399,12 +743,16 @@ struct sinus : unary_function<sinus<T>> {
 
   constexpr explicit sinus(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return math<S>::sin(x);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::sin(arg(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
 private:
@@ -413,7 +761,7 @@ private:
 
 template <typename T>
 constexpr auto cos(T x) noexcept {
-  return cosinus(as_expression(x));
+  return fold_constant(cosinus(as_expression(x)));
 }
 
 template <typename T>
@@ -429,12 +777,16 @@ struct cosinus : unary_function<cosinus<T>> {
 
   constexpr explicit cosinus(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return math<S>::cos(x);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::cos(arg(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
 private:
@@ -443,7 +795,7 @@ private:
 
 template <typename T>
 constexpr auto tan(T x) noexcept {
-  return tangens(as_expression(x));
+  return fold_constant(tangens(as_expression(x)));
 }
 
 template <typename T>
@@ -459,12 +811,16 @@ struct tangens : unary_function<tangens<T>> {
 
   constexpr explicit tangens(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return math<S>::tan(x);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::tan(arg(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
 private:
@@ -475,7 +831,7 @@ private:
 
 template <typename T>
 constexpr auto sinh(T x) noexcept {
-  return sinus_hyperbolicus(as_expression(x));
+  return fold_constant(sinus_hyperbolicus(as_expression(x)));
 }
 
 template <typename T>
@@ -491,12 +847,16 @@ struct sinus_hyperbolicus : unary_function<sinus_hyperbolicus<T>> {
 
   constexpr explicit sinus_hyperbolicus(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return math<S>::sinh(x);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::sinh(arg(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
 private:
@@ -505,7 +865,7 @@ private:
 
 template <typename T>
 constexpr auto cosh(T x) noexcept {
-  return cosinus_hyperbolicus(as_expression(x));
+  return fold_constant(cosinus_hyperbolicus(as_expression(x)));
 }
 
 template <typename T>
@@ -521,12 +881,16 @@ struct cosinus_hyperbolicus : unary_function<cosinus_hyperbolicus<T>> {
 
   constexpr explicit cosinus_hyperbolicus(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return math<S>::cosh(x);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::cosh(arg(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
 private:
@@ -535,7 +899,7 @@ private:
 
 template <typename T>
 constexpr auto tanh(T x) noexcept {
-  return tangens_hyperbolicus(as_expression(x));
+  return fold_constant(tangens_hyperbolicus(as_expression(x)));
 }
 
 template <typename T>
@@ -551,12 +915,16 @@ struct tangens_hyperbolicus : unary_function<tangens_hyperbolicus<T>> {
 
   constexpr explicit tangens_hyperbolicus(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return math<S>::tanh(x);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::tanh(arg(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
 private:
@@ -567,7 +935,7 @@ private:
 
 template <typename T>
 constexpr auto asin(T x) noexcept {
-  return arcus_sinus(as_expression(x));
+  return fold_constant(arcus_sinus(as_expression(x)));
 }
 
 template <typename T>
@@ -583,12 +951,16 @@ struct arcus_sinus : unary_function<arcus_sinus<T>> {
 
   constexpr explicit arcus_sinus(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return math<S>::asin(x);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::asin(arg(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
 private:
@@ -599,7 +971,7 @@ private:
 
 template <typename T>
 constexpr auto acos(T x) noexcept {
-  return arcus_cosinus(as_expression(x));
+  return fold_constant(arcus_cosinus(as_expression(x)));
 }
 
 template <typename T>
@@ -615,12 +987,16 @@ struct arcus_cosinus : unary_function<arcus_cosinus<T>> {
 
   constexpr explicit arcus_cosinus(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return math<S>::acos(x);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::acos(arg(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
 private:
@@ -631,7 +1007,7 @@ private:
 
 template <typename T>
 constexpr auto atan(T x) noexcept {
-  return arcus_tangens(as_expression(x));
+  return fold_constant(arcus_tangens(as_expression(x)));
 }
 
 template <typename T>
@@ -647,12 +1023,16 @@ struct arcus_tangens : unary_function<arcus_tangens<T>> {
 
   constexpr explicit arcus_tangens(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return math<S>::atan(x);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::atan(arg(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
 private:
@@ -663,7 +1043,7 @@ private:
 
 template <typename T>
 constexpr auto asinh(T x) noexcept {
-  return area_sinus_hyperbolicus(as_expression(x));
+  return fold_constant(area_sinus_hyperbolicus(as_expression(x)));
 }
 
 template <typename T>
@@ -679,12 +1059,16 @@ struct area_sinus_hyperbolicus : unary_function<area_sinus_hyperbolicus<T>> {
 
   constexpr explicit area_sinus_hyperbolicus(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return math<S>::asinh(x);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::asinh(arg(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
 private:
@@ -695,7 +1079,7 @@ private:
 
 template <typename T>
 constexpr auto acosh(T x) noexcept {
-  return area_cosinus_hyperbolicus(as_expression(x));
+  return fold_constant(area_cosinus_hyperbolicus(as_expression(x)));
 }
 
 template <typename T>
@@ -712,12 +1096,16 @@ struct area_cosinus_hyperbolicus
 
   constexpr explicit area_cosinus_hyperbolicus(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return math<S>::acosh(x);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::acosh(arg(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
 private:
@@ -728,7 +1116,7 @@ private:
 
 template <typename T>
 constexpr auto atanh(T x) noexcept {
-  return area_tangens_hyperbolicus(as_expression(x));
+  return fold_constant(area_tangens_hyperbolicus(as_expression(x)));
 }
 
 template <typename T>
@@ -745,12 +1133,16 @@ struct area_tangens_hyperbolicus
 
   constexpr explicit area_tangens_hyperbolicus(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return math<S>::atanh(x);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::atanh(arg(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
 private:
@@ -759,6 +1151,83 @@ private:
   }
 };
 
+// Shape of a polynomial in at most one variable with static coefficients that
+// is built from `+`, `-`, `*` and `pow` with non-negative integral exponents.
+// `degree` is an upper bound and `sum` tells whether it has more than one term.
+struct polynomial_shape {
+  bool valid;
+  long variable;
+  long degree;
+  bool sum;
+};
+
+constexpr polynomial_shape combine_shapes(
+    polynomial_shape l,
+    polynomial_shape r,
+    long degree,
+    bool sum
+) noexcept {
+  const bool same_variable =
+      l.variable < 0 || r.variable < 0 || l.variable == r.variable;
+  return {
+      l.valid && r.valid && same_variable,
+      l.variable < 0 ? r.variable : l.variable,
+      degree,
+      sum};
+}
+
+template <typename E>
+inline constexpr polynomial_shape polynomial_shape_v{false, -1, 0, false};
+
+template <long N, long D>
+inline constexpr polynomial_shape polynomial_shape_v<static_constant<N, D>>{
+    true, -1, 0, false};
+
+template <std::size_t N>
+inline constexpr polynomial_shape polynomial_shape_v<variable<N>>{
+    true, static_cast<long>(N), 1, false};
+
+template <typename T>
+inline constexpr polynomial_shape polynomial_shape_v<negation<T>> =
+    polynomial_shape_v<T>;
+
+template <typename L, typename R>
+inline constexpr polynomial_shape polynomial_shape_v<addition<L, R>> =
+    combine_shapes(
+        polynomial_shape_v<L>,
+        polynomial_shape_v<R>,
+        std::max(polynomial_shape_v<L>.degree, polynomial_shape_v<R>.degree),
+        true
+    );
+
+template <typename L, typename R>
+inline constexpr polynomial_shape polynomial_shape_v<subtraction<L, R>> =
+    polynomial_shape_v<addition<L, R>>;
+
+template <typename L, typename R>
+inline constexpr polynomial_shape polynomial_shape_v<multiplication<L, R>> =
+    combine_shapes(
+        polynomial_shape_v<L>,
+        polynomial_shape_v<R>,
+        polynomial_shape_v<L>.degree + polynomial_shape_v<R>.degree,
+        polynomial_shape_v<L>.sum || polynomial_shape_v<R>.sum
+    );
+
+template <typename L, long K>
+inline constexpr polynomial_shape
+    polynomial_shape_v<power<L, static_constant<K>>>{
+        polynomial_shape_v<L>.valid && K >= 0,
+        polynomial_shape_v<L>.variable,
+        polynomial_shape_v<L>.degree * K,
+        polynomial_shape_v<L>.sum};
+
+// Polynomials in one variable with more than one term and at least quadratic,
+// whose derivatives are taken by shifting coefficients
+template <typename E>
+inline constexpr bool has_polynomial_form_v =
+    polynomial_shape_v<E>.valid && polynomial_shape_v<E>.variable >= 0
+    && polynomial_shape_v<E>.degree >= 2 && polynomial_shape_v<E>.sum;
+
 template <
     typename L,
     typename R,
@@ -772,12 +1241,18 @@ template <
     typename R,
     std::enable_if_t<is_constant_v<L> && is_constant_v<R>>* = nullptr>
 constexpr auto operator+(L l, R r) noexcept {
-  return runtime_constant{l.value() + r.value()};
+  if constexpr (is_literal_constant_v<L> && is_literal_constant_v<R>) {
+    return runtime_constant{l.value() + r.value()};
+  }
+  else {
+    return constant_function{addition(l, r)};
+  }
 }
 
-template <long N1, long N2>
-constexpr auto operator+(static_constant<N1>, static_constant<N2>) noexcept {
-  return static_constant<N1 + N2>{};
+template <long N1, long D1, long N2, long D2>
+constexpr auto
+operator+(static_constant<N1, D1>, static_constant<N2, D2>) noexcept {
+  return rational_t<N1 * D2 + N2 * D1, D1 * D2>{};
 }
 
 template <typename T, std::enable_if_t<!is_static_constant_v<T>>* = nullptr>
@@ -790,6 +1265,83 @@ constexpr auto operator+(T x, zero) noexcept {
   return as_expression(x);
 }
 
+template <typename T>
+inline constexpr bool is_multiplication_v = false;
+
+template <typename L, typename R>
+inline constexpr bool is_multiplication_v<multiplication<L, R>> = true;
+
+// Sums and differences with a product operand, which are evaluated as
+// `E::fused(x, y, z)` from the factors `x` and `y` of the product and the other
+// operand `z`
+template <typename E>
+inline constexpr bool is_fused_v = false;
+
+template <typename L, typename R>
+inline constexpr bool is_fused_v<addition<L, R>> =
+    AD_FMA && (is_multiplication_v<L> || is_multiplication_v<R>);
+
+template <typename L, typename R>
+inline constexpr bool is_fused_v<subtraction<L, R>> =
+    AD_FMA && (is_multiplication_v<L> || is_multiplication_v<R>);
+
+template <typename E>
+struct fused_operands {
+  static constexpr bool left = is_multiplication_v<operand_t<E, 0>>;
+
+  using product = operand_t<E, left ? 0 : 1>;
+  using other   = operand_t<E, left ? 1 : 0>;
+
+  static constexpr const product& product_of(const E& x) noexcept {
+    if constexpr (left) {
+      return x.lhs;
+    }
+    else {
+      return x.rhs;
+    }
+  }
+
+  static constexpr const other& other_of(const E& x) noexcept {
+    if constexpr (left) {
+      return x.rhs;
+    }
+    else {
+      return x.lhs;
+    }
+  }
+};
+
+// Returns `x * y + z` rounded once for floating-point types if `AD_FMA` is set
+template <typename S>
+constexpr S multiply_add(S x, S y, S z) noexcept {
+#if AD_FMA
+  if constexpr (std::is_floating_point_v<S>) {
+#  if defined(__cpp_lib_is_constant_evaluated)
+    if (!std::is_constant_evaluated()) {
+      return std::fma(x, y, z);
+    }
+#  else
+    return std::fma(x, y, z);
+#  endif
+  }
+#endif
+  return x * y + z;
+}
+
+// Returns the values of both factors of `x`. The operand of a square is only
+// evaluated once.
+template <typename L, typename R, typename... Ts>
+constexpr auto
+evaluate_factors(const multiplication<L, R>& x, Ts... xs) noexcept {
+  const auto l = x.lhs(xs...);
+  if constexpr (is_static_same_v<L, R>) {
+    return std::pair(l, l);
+  }
+  else {
+    return std::pair(l, x.rhs(xs...));
+  }
+}
+
 template <typename L, typename R>
 struct addition : expression<addition<L, R>> {
   using expression<addition>::derive;
@@ -798,17 +1350,38 @@ struct addition : expression<addition<L, R>> {
 
   constexpr explicit addition(L lhs_, R rhs_) noexcept : lhs(lhs_), rhs(rhs_) {}
 
+  template <typename S>
+  static constexpr S apply(S l, S r) noexcept {
+    return l + r;
+  }
+
+  template <typename S>
+  static constexpr S fused(S x, S y, S z) noexcept {
+    return multiply_add(x, y, z);
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return lhs(xs...) + rhs(xs...);
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    if constexpr (is_fused_v<addition>) {
+      using operands    = fused_operands<addition>;
+      const auto [l, r] = evaluate_factors(operands::product_of(*this), xs...);
+      return fused(l, r, operands::other_of(*this)(xs...));
+    }
+    else {
+      return apply(lhs(xs...), rhs(xs...));
+    }
   }
 
   template <std::size_t I = 0>
   constexpr auto derive() const noexcept {
-    return lhs.template derive<I>() + rhs.template derive<I>();
+    if constexpr (has_polynomial_form_v<addition>) {
+      return polynomial_form(*this).template derive<I>();
+    }
+    else {
+      return lhs.template derive<I>() + rhs.template derive<I>();
+    }
   }
 };
 
@@ -830,12 +1403,18 @@ template <
     typename R,
     std::enable_if_t<is_constant_v<L> && is_constant_v<R>>* = nullptr>
 constexpr auto operator-(L l, R r) noexcept {
-  return runtime_constant{l.value() - r.value()};
-}
+  if constexpr (is_literal_constant_v<L> && is_literal_constant_v<R>) {
+    return runtime_constant{l.value() - r.value()};
+  }
+  else {
+    return constant_function{subtraction(l, r)};
+  }
+}
 
-template <long N1, long N2>
-constexpr auto operator-(static_constant<N1>, static_constant<N2>) noexcept {
-  return static_constant<N1 - N2>{};
+template <long N1, long D1, long N2, long D2>
+constexpr auto
+operator-(static_constant<N1, D1>, static_constant<N2, D2>) noexcept {
+  return rational_t<N1 * D2 - N2 * D1, D1 * D2>{};
 }
 
 template <typename T, std::enable_if_t<!is_static_constant_v<T>>* = nullptr>
@@ -857,17 +1436,43 @@ struct subtraction : expression<subtraction<L, R>> {
   constexpr explicit subtraction(L lhs_, R rhs_) noexcept
       : lhs(lhs_), rhs(rhs_) {}
 
+  template <typename S>
+  static constexpr S apply(S l, S r) noexcept {
+    return l - r;
+  }
+
+  template <typename S>
+  static constexpr S fused(S x, S y, S z) noexcept {
+    if constexpr (is_multiplication_v<L>) {
+      return multiply_add(x, y, -z);
+    }
+    else {
+      return multiply_add(-x, y, z);
+    }
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return lhs(xs...) - rhs(xs...);
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    if constexpr (is_fused_v<subtraction>) {
+      using operands    = fused_operands<subtraction>;
+      const auto [l, r] = evaluate_factors(operands::product_of(*this), xs...);
+      return fused(l, r, operands::other_of(*this)(xs...));
+    }
+    else {
+      return apply(lhs(xs...), rhs(xs...));
+    }
   }
 
   template <std::size_t I = 0>
   constexpr auto derive() const noexcept {
-    return lhs.template derive<I>() - rhs.template derive<I>();
+    if constexpr (has_polynomial_form_v<subtraction>) {
+      return polynomial_form(*this).template derive<I>();
+    }
+    else {
+      return lhs.template derive<I>() - rhs.template derive<I>();
+    }
   }
 };
 
@@ -880,17 +1485,34 @@ struct multiplication : expression<multiplication<L, R>> {
   constexpr explicit multiplication(L lhs_, R rhs_) noexcept
       : lhs(lhs_), rhs(rhs_) {}
 
+  template <typename S>
+  static constexpr S apply(S l, S r) noexcept {
+    return l * r;
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return lhs(xs...) * rhs(xs...);
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    if constexpr (is_static_same_v<L, R>) {
+      // `x * x` evaluates `x` once
+      const auto l = lhs(xs...);
+      return apply(l, l);
+    }
+    else {
+      return apply(lhs(xs...), rhs(xs...));
+    }
   }
 
   template <std::size_t I = 0>
   constexpr auto derive() const noexcept {
-    return lhs.template derive<I>() * rhs + lhs * rhs.template derive<I>();
+    if constexpr (has_polynomial_form_v<multiplication>
+                  && !is_static_same_v<L, R>) {
+      return polynomial_form(*this).template derive<I>();
+    }
+    else {
+      return lhs.template derive<I>() * rhs + lhs * rhs.template derive<I>();
+    }
   }
 };
 
@@ -907,12 +1529,33 @@ template <
     typename R,
     std::enable_if_t<is_constant_v<L> && is_constant_v<R>>* = nullptr>
 constexpr auto operator*(L l, R r) noexcept {
-  return runtime_constant{l.value() * r.value()};
+  if constexpr (is_literal_constant_v<L> && is_literal_constant_v<R>) {
+    return runtime_constant{l.value() * r.value()};
+  }
+  else {
+    return constant_function{multiplication(l, r)};
+  }
 }
 
-template <long N1, long N2>
-constexpr auto operator*(static_constant<N1>, static_constant<N2>) noexcept {
-  return static_constant<N1 * N2>{};
+template <long N1, long D1, long N2, long D2>
+constexpr auto
+operator*(static_constant<N1, D1>, static_constant<N2, D2>) noexcept {
+  return rational_t<N1 * N2, D1 * D2>{};
+}
+
+// Collects the constant factors of repeated scaling, e.g. by division by
+// constants
+template <
+    long N1,
+    long D1,
+    long N2,
+    long D2,
+    typename T,
+    std::enable_if_t<N1 != 0 && N1 != D1>* = nullptr>
+constexpr auto operator*(
+    static_constant<N1, D1>, multiplication<static_constant<N2, D2>, T> r
+) noexcept {
+  return rational_t<N1 * N2, D1 * D2>{} * r.rhs;
 }
 
 template <typename T, std::enable_if_t<!is_static_constant_v<T>>* = nullptr>
@@ -948,7 +1591,8 @@ constexpr auto operator*(exponential<L> l, exponential<R> r) noexcept {
 template <
     typename L,
     typename R,
-    std::enable_if_t<!std::is_same_v<L, unity>>* = nullptr>
+    std::enable_if_t<
+        !std::is_same_v<L, unity> && !std::is_same_v<L, zero>>* = nullptr>
 constexpr auto operator*(L l, division<unity, R> r) noexcept {
   return l / r.rhs;
 }
@@ -956,11 +1600,18 @@ constexpr auto operator*(L l, division<unity, R> r) noexcept {
 template <
     typename L,
     typename R,
-    std::enable_if_t<!std::is_same_v<R, unity>>* = nullptr>
+    std::enable_if_t<
+        !std::is_same_v<R, unity> && !std::is_same_v<R, zero>>* = nullptr>
 constexpr auto operator*(division<unity, L> l, R r) noexcept {
   return r / l.rhs;
 }
 
+template <typename L, typename R>
+constexpr auto
+operator*(division<unity, L> l, division<unity, R> r) noexcept {
+  return unity{} / (l.rhs * r.rhs);
+}
+
 template <
     typename L,
     typename R,
@@ -974,21 +1625,48 @@ constexpr auto operator/([[maybe_unused]] L l, [[maybe_unused]] R r) noexcept {
   }
 }
 
-// TODO: Overload for static_constant?
 template <
     typename L,
     typename R,
     std::enable_if_t<is_constant_v<L> && is_constant_v<R>>* = nullptr>
 constexpr auto operator/(L l, R r) noexcept {
-  return runtime_constant{l.value() / r.value()};
+  if constexpr (is_literal_constant_v<L> && is_literal_constant_v<R>) {
+    return runtime_constant{l.value() / r.value()};
+  }
+  else {
+    return constant_function{division(l, r)};
+  }
 }
 
-template <typename R>
+template <long N1, long D1, long N2, long D2>
+constexpr auto
+operator/(static_constant<N1, D1>, static_constant<N2, D2>) noexcept {
+  if constexpr (N1 == 0) {
+    return zero{};
+  }
+  else {
+    static_assert(N2 != 0, "division by zero");
+    return rational_t<N1 * D2, D1 * N2>{};
+  }
+}
+
+template <typename R, std::enable_if_t<!is_static_constant_v<R>>* = nullptr>
 constexpr auto operator/(zero, R) noexcept {
   return zero{};
 }
 
-template <typename L>
+// Division by a static constant is multiplication by its exact reciprocal
+template <
+    typename L,
+    long N,
+    long D,
+    std::enable_if_t<!is_static_constant_v<L>>* = nullptr>
+constexpr auto operator/(L l, static_constant<N, D>) noexcept {
+  static_assert(N != 0, "division by zero");
+  return rational_t<D, N>{} * l;
+}
+
+template <typename L, std::enable_if_t<!is_static_constant_v<L>>* = nullptr>
 constexpr auto operator/(L l, unity) noexcept {
   return as_expression(l);
 }
@@ -998,7 +1676,11 @@ constexpr auto operator/(T l, division<L, R> r) noexcept {
   return l * r.rhs / r.lhs;
 }
 
-template <typename L, typename R, typename T>
+template <
+    typename L,
+    typename R,
+    typename T,
+    std::enable_if_t<!is_static_constant_v<T>>* = nullptr>
 constexpr auto operator/(division<L, R> l, T r) noexcept {
   return l.lhs / (l.rhs * r);
 }
@@ -1013,20 +1695,62 @@ constexpr auto operator/(exponential<L> l, exponential<R> r) noexcept {
   return exp(l.arg - r.arg);
 }
 
+// `1 / sqrt(x)` is evaluated in one step, and its derivatives are powers of
+// `x` as well
+template <typename T>
+constexpr auto operator/(unity, square_root<T> r) noexcept {
+  return pow(r.arg, static_constant<-1, 2>{});
+}
+
+// The reciprocal of a runtime constant divisor, computed once so that the
+// division can be evaluated as a multiplication. It is zero unless it is a
+// normal number in every scalar type, in which case the division is kept.
+template <typename R>
+struct divisor_reciprocal {
+  constexpr explicit divisor_reciprocal(R) noexcept {}
+};
+
+template <>
+struct divisor_reciprocal<runtime_constant> {
+  double value = 0;
+
+  constexpr explicit divisor_reciprocal(runtime_constant r) noexcept {
+    if (r.value() != 0) {
+      const double k         = 1.0 / r.value();
+      const double magnitude = k < 0 ? -k : k;
+      if (magnitude >= std::numeric_limits<float>::min()
+          && magnitude <= std::numeric_limits<float>::max()) {
+        value = k;
+      }
+    }
+  }
+};
+
 template <typename L, typename R>
 struct division : expression<division<L, R>> {
   using expression<division>::derive;
   AD_NO_UNIQUE_ADDRESS L lhs;
   AD_NO_UNIQUE_ADDRESS R rhs;
+  AD_NO_UNIQUE_ADDRESS divisor_reciprocal<R> reciprocal;
+
+  constexpr explicit division(L lhs_, R rhs_) noexcept
+      : lhs(lhs_), rhs(rhs_), reciprocal(rhs_) {}
 
-  constexpr explicit division(L lhs_, R rhs_) noexcept : lhs(lhs_), rhs(rhs_) {}
+  template <typename S>
+  static constexpr S apply(S l, S r) noexcept {
+    return l / r;
+  }
 
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return lhs(xs...) / rhs(xs...);
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    if constexpr (std::is_same_v<R, runtime_constant>) {
+      if (reciprocal.value != 0) {
+        return lhs(xs...) * static_cast<scalar_t<Ts...>>(reciprocal.value);
+      }
+    }
+    return apply(lhs(xs...), rhs(xs...));
   }
 
   template <std::size_t I = 0>
@@ -1035,15 +1759,29 @@ struct division : expression<division<L, R>> {
       return lhs.template derive<I>() / rhs;
     }
     else {
-      return (lhs.template derive<I>() * rhs)
-             - (lhs * rhs.template derive<I>()) / (rhs * rhs);
+      return (lhs.template derive<I>() * rhs - lhs * rhs.template derive<I>())
+             / (rhs * rhs);
     }
   }
 };
 
 template <typename L, typename R>
 constexpr auto pow(L l, R r) noexcept {
-  return power(as_expression(l), as_expression(r));
+  if constexpr (is_static_constant_v<L> && is_integral_constant_v<R>) {
+    constexpr long k = R::numerator < 0 ? -R::numerator : R::numerator;
+    using result     = static_constant<
+        integral_power(L::numerator, k),
+        integral_power(L::denominator, k)>;
+    if constexpr (R::numerator < 0) {
+      return unity{} / result{};
+    }
+    else {
+      return result{};
+    }
+  }
+  else {
+    return fold_constant(power(as_expression(l), as_expression(r)));
+  }
 }
 
 template <typename T>
@@ -1075,6 +1813,16 @@ constexpr auto pow(division<L, R> lhs, negation<T> rhs) noexcept {
   return pow(lhs.rhs / lhs.lhs, rhs.arg);
 }
 
+template <
+    typename L,
+    typename R,
+    long N,
+    long D,
+    std::enable_if_t<(N < 0)>* = nullptr>
+constexpr auto pow(division<L, R> lhs, static_constant<N, D>) noexcept {
+  return pow(lhs.rhs / lhs.lhs, static_constant<-N, D>{});
+}
+
 template <typename L, typename R>
 constexpr auto pow(exponential<L> lhs, R rhs) noexcept {
   return exp(lhs.arg * rhs);
@@ -1085,6 +1833,45 @@ constexpr auto pow(power<L, R> lhs, T rhs) noexcept {
   return pow(lhs.lhs, lhs.rhs * rhs);
 }
 
+// Returns `x^(N / D)` for `D == 1` by repeated squaring and for `D == 2` with a
+// single square root
+template <long N, long D, typename S>
+constexpr S static_pow(S x) noexcept {
+  static_assert(D == 1 || D == 2);
+  if constexpr (N < 0) {
+    return S(1) / static_pow<-N, D>(x);
+  }
+  else if constexpr (D == 2) {
+    if constexpr (N == 1) {
+      return math<S>::sqrt(x);
+    }
+    else {
+      return static_pow<N / 2, 1>(x) * math<S>::sqrt(x);
+    }
+  }
+  else if constexpr (N == 0) {
+    return S(1);
+  }
+  else if constexpr (N == 1) {
+    return x;
+  }
+  else {
+    const S half = static_pow<N / 2, 1>(x);
+    if constexpr (N % 2 == 0) {
+      return half * half;
+    }
+    else {
+      return half * half * x;
+    }
+  }
+}
+
+template <typename T>
+inline constexpr bool has_static_pow_v = false;
+
+template <long N, long D>
+inline constexpr bool has_static_pow_v<static_constant<N, D>> = D <= 2;
+
 template <typename L, typename R>
 struct power : expression<power<L, R>> {
   using expression<power>::derive;
@@ -1093,12 +1880,21 @@ struct power : expression<power<L, R>> {
 
   constexpr explicit power(L lhs_, R rhs_) noexcept : lhs(lhs_), rhs(rhs_) {}
 
+  template <typename S>
+  static constexpr S apply(S l, [[maybe_unused]] S r) noexcept {
+    if constexpr (has_static_pow_v<R>) {
+      return static_pow<R::numerator, R::denominator>(l);
+    }
+    else {
+      return math<S>::pow(l, r);
+    }
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return std::pow(lhs(xs...), rhs(xs...));
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(lhs(xs...), rhs(xs...));
   }
 
   template <std::size_t I = 0>
@@ -1107,8 +1903,9 @@ struct power : expression<power<L, R>> {
       return lhs.template derive<I>() * rhs * pow(lhs, rhs - unity{});
     }
     else {
-      return *this * (lhs.template derive<I>() * rhs / lhs)
-             + (log(lhs) * rhs.template derive<I>());
+      return *this
+             * (lhs.template derive<I>() * rhs / lhs
+                + log(lhs) * rhs.template derive<I>());
     }
   }
 };
@@ -1122,7 +1919,12 @@ constexpr auto operator+(T x) noexcept {
 // Don't need `as_expression` here since `operator-` is only findable via adl
 template <typename T>
 constexpr auto operator-(T x) noexcept {
-  return negation(x);
+  if constexpr (is_literal_constant_v<T>) {
+    return runtime_constant{-x.value()};
+  }
+  else {
+    return fold_constant(negation(x));
+  }
 }
 
 template <typename T>
@@ -1130,8 +1932,9 @@ constexpr auto operator-(negation<T> x) noexcept {
   return x.arg;
 }
 
-constexpr auto operator-(zero) noexcept {
-  return zero{};
+template <long N, long D>
+constexpr auto operator-(static_constant<N, D>) noexcept {
+  return static_constant<-N, D>{};
 }
 
 template <typename L, typename R>
@@ -1151,74 +1954,1281 @@ struct negation : expression<negation<T>> {
 
   constexpr explicit negation(T x) noexcept : arg(x) {}
 
+  template <typename S>
+  static constexpr S apply(S x) noexcept {
+    return -x;
+  }
+
   template <
       typename... Ts,
-      std::enable_if_t<
-          std::conjunction_v<std::is_convertible<Ts, double>...>>* = nullptr>
-  constexpr double operator()(Ts... xs) const noexcept {
-    return -arg(xs...);
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    return apply(arg(xs...));
   }
 
   template <std::size_t I = 0>
   constexpr auto derive() const noexcept {
-    return -arg.template derive<I>();
+    if constexpr (has_polynomial_form_v<negation>) {
+      return polynomial_form(*this).template derive<I>();
+    }
+    else {
+      return -arg.template derive<I>();
+    }
   }
 };
 
-constexpr long parse_integral(const char* s) noexcept {
-  long res = 0;
-  for (; *s; ++s) {
-    res *= 10;
-    res += *s - '0';
+template <typename T>
+struct tag {
+  using type = T;
+};
+
+// Polynomials of degree at least this are evaluated by Estrin's scheme, whose
+// independent subpolynomials make up for the additional squarings
+inline constexpr std::size_t estrin_degree = 8;
+
+// Static coefficients `Cs[0] + Cs[1] x + Cs[2] x^2 + ...` of a polynomial,
+// lowest degree first. `polynomial<T>` is the polynomial of the expression `T`.
+template <typename... Cs>
+struct univariate {
+  template <std::size_t I>
+  using coefficient = std::tuple_element_t<I, std::tuple<Cs...>>;
+
+  inline static constexpr std::size_t degree = sizeof...(Cs) - 1;
+
+  static constexpr unsigned long long hash() noexcept {
+    unsigned long long h   = 0xcbf29ce484222325ull;
+    const long fractions[] = {Cs::numerator..., Cs::denominator...};
+    for (const long c : fractions) {
+      h = (h ^ static_cast<unsigned long long>(c)) * 0x100000001b3ull;
+    }
+    return h;
   }
-  return res;
+
+  template <typename S>
+  static constexpr S evaluate(S x) noexcept {
+    if constexpr (degree < estrin_degree) {
+      return horner<0>(x);
+    }
+    else {
+      std::array<S, levels(sizeof...(Cs))> powers{x};
+      for (std::size_t i = 1; i < powers.size(); ++i) {
+        powers[i] = powers[i - 1] * powers[i - 1];
+      }
+      return estrin<0, sizeof...(Cs)>(powers);
+    }
+  }
+
+  // Returns the sum of the first `N` terms as powers of `arg` added to `acc`
+  template <std::size_t N, std::size_t I = 0, typename T, typename Acc = zero>
+  static constexpr auto expand(T arg, Acc acc = {}) noexcept {
+    if constexpr (I == N) {
+      return acc;
+    }
+    else {
+      using C         = coefficient<I>;
+      const auto term = pow(arg, static_constant<I>{});
+      if constexpr (C::numerator < 0) {
+        return expand<N, I + 1>(arg, acc - -C{} * term);
+      }
+      else {
+        return expand<N, I + 1>(arg, acc + C{} * term);
+      }
+    }
+  }
+
+  template <std::size_t... Is>
+  static auto derivative(std::index_sequence<Is...>) -> univariate<
+      decltype(static_constant<Is + 1>{} * coefficient<Is + 1>{})...>;
+
+  using derivative_t = decltype(derivative(std::make_index_sequence<degree>{}));
+
+  template <typename T>
+  struct polynomial : unary_function<polynomial<T>> {
+    using unary_function<polynomial>::derive;
+    friend struct unary_function<polynomial<T>>;
+    using coefficients = univariate;
+    AD_NO_UNIQUE_ADDRESS T arg;
+
+    constexpr explicit polynomial(T x) noexcept : arg(x) {}
+
+    template <typename S>
+    static constexpr S apply(S x) noexcept {
+      return evaluate(x);
+    }
+
+    template <
+        typename... Ts,
+        std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+    constexpr auto operator()(Ts... xs) const noexcept {
+      return apply(arg(xs...));
+    }
+
+    constexpr auto expand() const noexcept {
+      return univariate::expand<sizeof...(Cs)>(arg);
+    }
+
+  private:
+    constexpr auto derive_outer() const noexcept {
+      return make_polynomial(derivative_t{}, arg);
+    }
+  };
+
+private:
+  template <typename S, std::size_t I>
+  static constexpr S value() noexcept {
+    return static_cast<S>(coefficient<I>{}.value());
+  }
+
+  template <std::size_t B, std::size_t L>
+  static constexpr bool vanishes() noexcept {
+    constexpr bool zeros[] = {std::is_same_v<Cs, zero>...};
+    for (std::size_t i = B; i < B + L; ++i) {
+      if (!zeros[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Number of powers `x^(2^k)` that Estrin's scheme uses for `n` coefficients
+  static constexpr std::size_t levels(std::size_t n) noexcept {
+    std::size_t k = 0;
+    for (; (std::size_t{2} << k) < n; ++k) {
+    }
+    return k + 1;
+  }
+
+  // Coefficients from `I` on divided by `x^I`
+  template <std::size_t I, typename S>
+  static constexpr S horner(S x) noexcept {
+    if constexpr (I == degree) {
+      return value<S, I>();
+    }
+    else if constexpr (
+        I + 1 == degree && std::is_same_v<coefficient<degree>, unity>
+    ) {
+      if constexpr (vanishes<I, 1>()) {
+        return x;
+      }
+      else {
+        return x + value<S, I>();
+      }
+    }
+    else if constexpr (vanishes<I, 1>()) {
+      return horner<I + 1>(x) * x;
+    }
+    else {
+      return multiply_add(horner<I + 1>(x), x, value<S, I>());
+    }
+  }
+
+  // Coefficients `[B, B + L)` divided by `x^B`, given `x^(2^k)` in `powers[k]`
+  template <std::size_t B, std::size_t L, typename S, std::size_t K>
+  static constexpr S estrin(const std::array<S, K>& powers) noexcept {
+    if constexpr (L == 1) {
+      return value<S, B>();
+    }
+    else {
+      constexpr std::size_t k    = levels(L) - 1;
+      constexpr std::size_t half = std::size_t{1} << k;
+      const S high = estrin<B + half, L - half>(powers);
+      if constexpr (vanishes<B, half>()) {
+        return high * powers[k];
+      }
+      else {
+        return multiply_add(high, powers[k], estrin<B, half>(powers));
+      }
+    }
+  }
+};
+
+template <typename T, typename = void>
+inline constexpr bool is_univariate_v = false;
+
+template <typename T>
+inline constexpr bool
+    is_univariate_v<T, std::void_t<typename T::coefficients>> = true;
+
+template <typename... Cs>
+constexpr std::size_t significant_coefficients() noexcept {
+  constexpr bool zeros[] = {std::is_same_v<Cs, zero>..., false};
+  std::size_t n          = 0;
+  for (std::size_t i = 0; i < sizeof...(Cs); ++i) {
+    if (!zeros[i]) {
+      n = i + 1;
+    }
+  }
+  return n;
 }
-} // namespace detail
 
-inline namespace literals {
-constexpr auto operator""_c(long double x) noexcept {
-  return detail::runtime_constant{static_cast<double>(x)};
+template <typename... Cs, std::size_t... Is>
+auto leading(std::index_sequence<Is...>)
+    -> univariate<std::tuple_element_t<Is, std::tuple<Cs...>>...>;
+
+// Returns the polynomial with the coefficients `Cs` of `arg`. Trailing zeros
+// are dropped, and constant and linear polynomials become plain expressions.
+template <typename... Cs, typename T>
+constexpr auto make_polynomial(univariate<Cs...>, T arg) noexcept {
+  constexpr std::size_t n = significant_coefficients<Cs...>();
+  if constexpr (n < 3) {
+    return univariate<Cs...>::template expand<n>(arg);
+  }
+  else {
+    using coefficients =
+        decltype(leading<Cs...>(std::make_index_sequence<n>{}));
+    return typename coefficients::template polynomial<T>(arg);
+  }
 }
 
-template <char... cs>
-constexpr auto operator""_c() noexcept {
-  constexpr const char s[] = {cs..., 0};
-  return detail::static_constant<detail::parse_integral(s)>{};
+// Coefficient `numerator / denominator` in lowest terms
+struct fraction {
+  long numerator;
+  long denominator;
+};
+
+constexpr fraction reduce(long numerator, long denominator) noexcept {
+  const long g = std::gcd(numerator, denominator);
+  return {numerator / g, denominator / g};
 }
-} // namespace literals
 
-using detail::runtime_constant;
-using detail::static_constant;
-using detail::variable;
+template <std::size_t K>
+using coefficient_array = std::array<fraction, K>;
 
-using detail::acos;
-using detail::acosh;
-using detail::asin;
-using detail::asinh;
-using detail::atan;
-using detail::atanh;
-using detail::cos;
-using detail::cosh;
-using detail::exp;
-using detail::log;
-using detail::pow;
-using detail::sin;
-using detail::sinh;
-using detail::sqrt;
-using detail::tan;
-using detail::tanh;
+template <std::size_t K>
+constexpr coefficient_array<K> zero_coefficients() noexcept {
+  coefficient_array<K> result{};
+  for (fraction& c : result) {
+    c = {0, 1};
+  }
+  return result;
+}
+
+// Coefficients of `l + sign * r`
+template <std::size_t M, std::size_t K>
+constexpr auto add_coefficients(
+    const coefficient_array<M>& l,
+    const coefficient_array<K>& r,
+    long sign
+) noexcept {
+  auto result = zero_coefficients<(M < K ? K : M)>();
+  for (std::size_t i = 0; i < M; ++i) {
+    result[i] = l[i];
+  }
+  for (std::size_t i = 0; i < K; ++i) {
+    const fraction a = result[i];
+    result[i]        = reduce(
+        a.numerator * r[i].denominator + sign * r[i].numerator * a.denominator,
+        a.denominator * r[i].denominator
+    );
+  }
+  return result;
+}
+
+template <std::size_t M, std::size_t K>
+constexpr auto multiply_coefficients(
+    const coefficient_array<M>& l, const coefficient_array<K>& r
+) noexcept {
+  auto result = zero_coefficients<M + K - 1>();
+  for (std::size_t i = 0; i < M; ++i) {
+    for (std::size_t j = 0; j < K; ++j) {
+      const fraction a = result[i + j];
+      const fraction b = reduce(
+          l[i].numerator * r[j].numerator, l[i].denominator * r[j].denominator
+      );
+      result[i + j] = reduce(
+          a.numerator * b.denominator + b.numerator * a.denominator,
+          a.denominator * b.denominator
+      );
+    }
+  }
+  return result;
+}
 
-inline namespace variables {
-inline constexpr variable<0> _0;
-inline constexpr variable<1> _1;
-inline constexpr variable<2> _2;
-inline constexpr variable<3> _3;
-inline constexpr variable<4> _4;
-inline constexpr variable<5> _5;
-inline constexpr variable<6> _6;
-inline constexpr variable<7> _7;
-inline constexpr variable<8> _8;
-inline constexpr variable<9> _9;
+template <long N, long D>
+constexpr auto coefficients_of(tag<static_constant<N, D>>) noexcept {
+  return coefficient_array<1>{fraction{N, D}};
+}
+
+template <std::size_t N>
+constexpr auto coefficients_of(tag<variable<N>>) noexcept {
+  return coefficient_array<2>{fraction{0, 1}, fraction{1, 1}};
+}
+
+template <typename T>
+constexpr auto coefficients_of(tag<negation<T>>) noexcept {
+  return add_coefficients(
+      zero_coefficients<1>(), coefficients_of(tag<T>{}), -1
+  );
+}
+
+template <typename L, typename R>
+constexpr auto coefficients_of(tag<addition<L, R>>) noexcept {
+  return add_coefficients(
+      coefficients_of(tag<L>{}), coefficients_of(tag<R>{}), 1
+  );
+}
+
+template <typename L, typename R>
+constexpr auto coefficients_of(tag<subtraction<L, R>>) noexcept {
+  return add_coefficients(
+      coefficients_of(tag<L>{}), coefficients_of(tag<R>{}), -1
+  );
+}
+
+template <typename L, typename R>
+constexpr auto coefficients_of(tag<multiplication<L, R>>) noexcept {
+  return multiply_coefficients(
+      coefficients_of(tag<L>{}), coefficients_of(tag<R>{})
+  );
+}
+
+template <typename L, long K>
+constexpr auto coefficients_of(tag<power<L, static_constant<K>>>) noexcept {
+  if constexpr (K == 0) {
+    return coefficient_array<1>{fraction{1, 1}};
+  }
+  else {
+    return multiply_coefficients(
+        coefficients_of(tag<power<L, static_constant<K - 1>>>{}),
+        coefficients_of(tag<L>{})
+    );
+  }
+}
+
+template <typename E>
+inline constexpr auto coefficients_v = coefficients_of(tag<E>{});
+
+template <typename E, std::size_t... Is>
+constexpr auto collect_polynomial(std::index_sequence<Is...>) noexcept {
+  using coefficients = univariate<static_constant<
+      coefficients_v<E>[Is].numerator,
+      coefficients_v<E>[Is].denominator>...>;
+  return make_polynomial(
+      coefficients{}, variable<polynomial_shape_v<E>.variable>()
+  );
+}
+
+// Returns `expr`, which must have a polynomial form, with its coefficients
+// collected into a single node
+template <typename E>
+constexpr auto polynomial_form(const E&) noexcept {
+  return collect_polynomial<E>(
+      std::make_index_sequence<coefficients_v<E>.size()>{}
+  );
+}
+
+// Canonical form of static expressions: Sums are flattened into monomials with
+// integral coefficients and products into factors with integral exponents.
+// Like terms and like factors are collected, and both are sorted by a
+// structural order on types, so equal expressions get the same type.
+
+template <typename B, long K>
+struct factor {
+  using base = B;
+  inline static constexpr long exponent = K;
+};
+
+template <typename... Fs>
+struct factors {};
+
+template <long C, typename Fs>
+struct monomial {};
+
+template <typename... Ms>
+struct polynomial {};
+
+// clang-format off
+template <typename E> inline constexpr long node_kind_v = is_univariate_v<E> ? 23 : -1;
+template <long N, long D> inline constexpr long node_kind_v<static_constant<N, D>> = 0;
+template <std::size_t N> inline constexpr long node_kind_v<variable<N>> = 1;
+template <typename T> inline constexpr long node_kind_v<negation<T>> = 2;
+template <typename L, typename R> inline constexpr long node_kind_v<addition<L, R>> = 3;
+template <typename L, typename R> inline constexpr long node_kind_v<subtraction<L, R>> = 4;
+template <typename L, typename R> inline constexpr long node_kind_v<multiplication<L, R>> = 5;
+template <typename L, typename R> inline constexpr long node_kind_v<division<L, R>> = 6;
+template <typename L, typename R> inline constexpr long node_kind_v<power<L, R>> = 7;
+template <typename T> inline constexpr long node_kind_v<exponential<T>> = 8;
+template <typename T> inline constexpr long node_kind_v<logarithm<T>> = 9;
+template <typename T> inline constexpr long node_kind_v<square_root<T>> = 10;
+template <typename T> inline constexpr long node_kind_v<sinus<T>> = 11;
+template <typename T> inline constexpr long node_kind_v<cosinus<T>> = 12;
+template <typename T> inline constexpr long node_kind_v<tangens<T>> = 13;
+template <typename T> inline constexpr long node_kind_v<sinus_hyperbolicus<T>> = 14;
+template <typename T> inline constexpr long node_kind_v<cosinus_hyperbolicus<T>> = 15;
+template <typename T> inline constexpr long node_kind_v<tangens_hyperbolicus<T>> = 16;
+template <typename T> inline constexpr long node_kind_v<arcus_sinus<T>> = 17;
+template <typename T> inline constexpr long node_kind_v<arcus_cosinus<T>> = 18;
+template <typename T> inline constexpr long node_kind_v<arcus_tangens<T>> = 19;
+template <typename T> inline constexpr long node_kind_v<area_sinus_hyperbolicus<T>> = 20;
+template <typename T> inline constexpr long node_kind_v<area_cosinus_hyperbolicus<T>> = 21;
+template <typename T> inline constexpr long node_kind_v<area_tangens_hyperbolicus<T>> = 22;
+// clang-format on
+
+// Sort key of a node: its kind, the index of a variable or the value of a
+// constant, and a hash of its operands. Comparing keys is cheap, and the order
+// among leaves is the natural one.
+struct sort_key {
+  long kind;
+  long payload;
+  unsigned long long hash;
+
+  constexpr bool operator<(const sort_key& other) const noexcept {
+    if (kind != other.kind) {
+      return kind < other.kind;
+    }
+    if (payload != other.payload) {
+      return payload < other.payload;
+    }
+    return hash < other.hash;
+  }
+
+  constexpr bool operator!=(const sort_key& other) const noexcept {
+    return kind != other.kind || payload != other.payload
+           || hash != other.hash;
+  }
+
+  constexpr unsigned long long combined() const noexcept {
+    unsigned long long h = hash;
+    h = (h ^ static_cast<unsigned long long>(kind)) * 0x100000001b3ull;
+    h = (h ^ static_cast<unsigned long long>(payload)) * 0x100000001b3ull;
+    return h;
+  }
+};
+
+template <typename E>
+inline constexpr sort_key sort_key_v{node_kind_v<E>, 0, 0xcbf29ce484222325ull};
+
+template <long N, long D>
+inline constexpr sort_key sort_key_v<static_constant<N, D>>{
+    0, N, static_cast<unsigned long long>(D)};
+
+template <std::size_t N>
+inline constexpr sort_key sort_key_v<variable<N>>{
+    1, static_cast<long>(N), 0xcbf29ce484222325ull};
+
+// Polynomial nodes are told apart by their coefficients as well
+template <typename E>
+constexpr unsigned long long coefficients_hash() noexcept {
+  if constexpr (is_univariate_v<E>) {
+    return E::coefficients::hash();
+  }
+  else {
+    return 0;
+  }
+}
+
+template <template <typename> typename F, typename T>
+inline constexpr sort_key sort_key_v<F<T>>{
+    node_kind_v<F<T>>,
+    0,
+    sort_key_v<T>.combined() ^ coefficients_hash<F<T>>()};
+
+template <template <typename, typename> typename F, typename L, typename R>
+inline constexpr sort_key sort_key_v<F<L, R>>{
+    node_kind_v<F<L, R>>,
+    0,
+    sort_key_v<L>.combined() * 31 + sort_key_v<R>.combined()};
+
+template <typename A, typename B>
+inline constexpr bool precedes_v = sort_key_v<A> < sort_key_v<B>;
+
+// Orders monomials lexicographically by their factors. Constant terms are
+// sorted last.
+template <typename... Bs, long... Ks, typename... Cs, long... Ls>
+constexpr bool monomial_precedes(
+    factors<factor<Bs, Ks>...>, factors<factor<Cs, Ls>...>
+) noexcept {
+  if constexpr (sizeof...(Bs) == 0) {
+    return false;
+  }
+  else if constexpr (sizeof...(Cs) == 0) {
+    return true;
+  }
+  else {
+    constexpr sort_key lhs[] = {sort_key_v<Bs>...};
+    constexpr sort_key rhs[] = {sort_key_v<Cs>...};
+    constexpr long lk[]      = {Ks...};
+    constexpr long rk[]      = {Ls...};
+    for (std::size_t i = 0; i < sizeof...(Bs) && i < sizeof...(Cs); ++i) {
+      if (lhs[i] != rhs[i]) {
+        return lhs[i] < rhs[i];
+      }
+      if (lk[i] != rk[i]) {
+        return lk[i] < rk[i];
+      }
+    }
+    return sizeof...(Bs) < sizeof...(Cs);
+  }
+}
+
+template <typename F, typename... Fs>
+constexpr auto prepend(F, factors<Fs...>) noexcept {
+  return factors<F, Fs...>{};
+}
+
+template <typename M, typename... Ms>
+constexpr auto prepend(M, polynomial<Ms...>) noexcept {
+  return polynomial<M, Ms...>{};
+}
+
+template <typename B, long K>
+constexpr auto insert(factor<B, K>, factors<>) noexcept {
+  return factors<factor<B, K>>{};
+}
+
+template <typename B, long K, typename B2, long K2, typename... Fs>
+constexpr auto insert(factor<B, K>, factors<factor<B2, K2>, Fs...>) noexcept {
+  if constexpr (std::is_same_v<B, B2>) {
+    if constexpr (K + K2 == 0) {
+      return factors<Fs...>{};
+    }
+    else {
+      return factors<factor<B, K + K2>, Fs...>{};
+    }
+  }
+  else if constexpr (precedes_v<B, B2>) {
+    return factors<factor<B, K>, factor<B2, K2>, Fs...>{};
+  }
+  else {
+    return prepend(
+        factor<B2, K2>{}, insert(factor<B, K>{}, factors<Fs...>{})
+    );
+  }
+}
+
+template <long C, typename Fs>
+constexpr auto insert(monomial<C, Fs>, polynomial<>) noexcept {
+  return polynomial<monomial<C, Fs>>{};
+}
+
+template <long C, typename Fs, long C2, typename Gs, typename... Ms>
+constexpr auto
+insert(monomial<C, Fs>, polynomial<monomial<C2, Gs>, Ms...>) noexcept {
+  if constexpr (std::is_same_v<Fs, Gs>) {
+    if constexpr (C + C2 == 0) {
+      return polynomial<Ms...>{};
+    }
+    else {
+      return polynomial<monomial<C + C2, Fs>, Ms...>{};
+    }
+  }
+  else if constexpr (monomial_precedes(Fs{}, Gs{})) {
+    return polynomial<monomial<C, Fs>, monomial<C2, Gs>, Ms...>{};
+  }
+  else {
+    return prepend(
+        monomial<C2, Gs>{}, insert(monomial<C, Fs>{}, polynomial<Ms...>{})
+    );
+  }
+}
+
+template <typename... Gs>
+constexpr auto merge(factors<>, factors<Gs...> gs) noexcept {
+  return gs;
+}
+
+template <typename F, typename... Fs, typename... Gs>
+constexpr auto merge(factors<F, Fs...>, factors<Gs...> gs) noexcept {
+  return merge(factors<Fs...>{}, insert(F{}, gs));
+}
+
+template <typename... Ns>
+constexpr auto add(polynomial<>, polynomial<Ns...> q) noexcept {
+  return q;
+}
+
+template <typename M, typename... Ms, typename... Ns>
+constexpr auto add(polynomial<M, Ms...>, polynomial<Ns...> q) noexcept {
+  return add(polynomial<Ms...>{}, insert(M{}, q));
+}
+
+template <long S, long... Cs, typename... Fs>
+constexpr auto scale(polynomial<monomial<Cs, Fs>...>) noexcept {
+  if constexpr (S == 0) {
+    return polynomial<>{};
+  }
+  else {
+    return polynomial<monomial<S * Cs, Fs>...>{};
+  }
+}
+
+template <typename T>
+constexpr T make_static() noexcept {
+  if constexpr (is_unary_v<T>) {
+    return T(make_static<operand_t<T, 0>>());
+  }
+  else if constexpr (is_binary_v<T>) {
+    return T(make_static<operand_t<T, 0>>(), make_static<operand_t<T, 1>>());
+  }
+  else {
+    return T();
+  }
+}
+
+template <typename L, typename R>
+constexpr auto times(L l, R r) noexcept {
+  if constexpr (std::is_same_v<L, unity>) {
+    return r;
+  }
+  else if constexpr (std::is_same_v<R, unity>) {
+    return l;
+  }
+  else {
+    return multiplication(l, r);
+  }
+}
+
+// Rebuilds `B^K` for `K > 0` by repeated squaring
+template <typename B, long K>
+constexpr auto rebuild(factor<B, K>) noexcept {
+  if constexpr (K == 1) {
+    return make_static<B>();
+  }
+  else {
+    const auto half   = rebuild(factor<B, K / 2>{});
+    const auto square = multiplication(half, half);
+    if constexpr (K % 2 == 0) {
+      return square;
+    }
+    else {
+      return multiplication(square, make_static<B>());
+    }
+  }
+}
+
+// Returns `B^K` if `B` is a constant and unity otherwise
+template <typename B, long K>
+constexpr auto constant_power() noexcept {
+  if constexpr (is_static_constant_v<B>) {
+    return pow(B{}, static_constant<K>{});
+  }
+  else {
+    return unity{};
+  }
+}
+
+template <typename... Bs, long... Ks>
+constexpr auto constant_factor(factors<factor<Bs, Ks>...>) noexcept {
+  return (unity{} * ... * constant_power<Bs, Ks>());
+}
+
+// Product of the non-constant factors with positive exponents for the
+// numerator or of those with negative exponents for the denominator
+template <bool Numerator, typename Acc>
+constexpr auto fold_factors(Acc acc, factors<>) noexcept {
+  return acc;
+}
+
+template <bool Numerator, typename Acc, typename B, long K, typename... Fs>
+constexpr auto fold_factors(Acc acc, factors<factor<B, K>, Fs...>) noexcept {
+  if constexpr ((K > 0) == Numerator && !is_static_constant_v<B>) {
+    constexpr long k = K > 0 ? K : -K;
+    return fold_factors<Numerator>(
+        times(acc, rebuild(factor<B, k>{})), factors<Fs...>{}
+    );
+  }
+  else {
+    return fold_factors<Numerator>(acc, factors<Fs...>{});
+  }
+}
+
+// Rebuilds `|C| * Fs` with the constant factors folded into the coefficient
+template <long C, typename Fs>
+constexpr auto rebuild(monomial<C, Fs>) noexcept {
+  constexpr long a  = C < 0 ? -C : C;
+  const auto c      = static_constant<a>{} * constant_factor(Fs{});
+  const auto num    = fold_factors<true>(unity{}, Fs{});
+  const auto den    = fold_factors<false>(unity{}, Fs{});
+  const auto scaled = [&] {
+    if constexpr (std::is_same_v<decltype(c), const unity>) {
+      return num;
+    }
+    else if constexpr (std::is_same_v<std::decay_t<decltype(num)>, unity>) {
+      return c;
+    }
+    else {
+      return multiplication(c, num);
+    }
+  }();
+  if constexpr (std::is_same_v<std::decay_t<decltype(den)>, unity>) {
+    return scaled;
+  }
+  else {
+    return division(scaled, den);
+  }
+}
+
+template <typename Acc>
+constexpr auto fold_monomials(Acc acc) noexcept {
+  return acc;
+}
+
+template <typename Acc, long C, typename Fs, typename... Ms>
+constexpr auto fold_monomials(Acc acc, monomial<C, Fs> m, Ms... ms) noexcept {
+  if constexpr (C < 0) {
+    return fold_monomials(subtraction(acc, rebuild(m)), ms...);
+  }
+  else {
+    return fold_monomials(addition(acc, rebuild(m)), ms...);
+  }
+}
+
+// Leads with the first positive term, so that only the terms after it are
+// subtracted
+template <typename P, typename... Ps>
+constexpr auto lead_positive(polynomial<P, Ps...>, polynomial<>) noexcept {
+  const auto first = rebuild(P{});
+  if constexpr (is_static_constant_v<std::decay_t<decltype(first)>>) {
+    return fold_monomials(-first, Ps{}...);
+  }
+  else {
+    return fold_monomials(negation(first), Ps{}...);
+  }
+}
+
+template <typename... Ps, long C, typename Fs, typename... Ms>
+constexpr auto
+lead_positive(polynomial<Ps...>, polynomial<monomial<C, Fs>, Ms...>) noexcept {
+  if constexpr (C > 0) {
+    return fold_monomials(rebuild(monomial<C, Fs>{}), Ps{}..., Ms{}...);
+  }
+  else {
+    return lead_positive(
+        polynomial<Ps..., monomial<C, Fs>>{}, polynomial<Ms...>{}
+    );
+  }
+}
+
+constexpr auto rebuild(polynomial<>) noexcept { return zero{}; }
+
+template <long C, typename... Ms>
+constexpr auto rebuild(polynomial<monomial<C, factors<>>, Ms...>) noexcept {
+  return fold_monomials(static_constant<C>{}, Ms{}...);
+}
+
+template <typename B, typename... Bs, long... Ks>
+constexpr long exponent_of(factors<factor<Bs, Ks>...>) noexcept {
+  long result = 0;
+  ((result = std::is_same_v<B, Bs> ? Ks : result), ...);
+  return result;
+}
+
+// Exponent of `B` with the sign of `K` and the smallest magnitude
+template <typename B, long K, long... Cs, typename... Fs>
+constexpr long common_exponent(polynomial<monomial<Cs, Fs>...>) noexcept {
+  long result          = 0;
+  const long signed_[] = {exponent_of<B>(Fs{}) * (K > 0 ? 1 : -1)...};
+  for (const long e : signed_) {
+    if (e > 0 && (result == 0 || e < result)) {
+      result = e;
+    }
+  }
+  return K > 0 ? result : -result;
+}
+
+template <typename... Fs, typename... Gs>
+constexpr auto operator|(factors<Fs...>, factors<Gs...>) noexcept {
+  return factors<Fs..., Gs...>{};
+}
+
+// Returns the factors of all monomials, possibly with duplicates
+template <long... Cs, typename... Fs>
+constexpr auto all_factors(polynomial<monomial<Cs, Fs>...>) noexcept {
+  return (factors<>{} | ... | Fs{});
+}
+
+template <std::size_t I, typename... Fs>
+constexpr auto element(factors<Fs...>) noexcept {
+  return std::tuple_element_t<I, std::tuple<Fs...>>{};
+}
+
+struct most_common_factor {
+  std::size_t index;
+  long count;
+};
+
+// Returns the factor whose base occurs with an exponent of the same sign in
+// most monomials, given the factors of all monomials
+template <typename... Bs, long... Ks>
+constexpr most_common_factor most_common(factors<factor<Bs, Ks>...>) noexcept {
+  constexpr sort_key keys[]  = {sort_key_v<Bs>...};
+  constexpr long exponents[] = {Ks...};
+  most_common_factor result{0, 0};
+  for (std::size_t i = 0; i < sizeof...(Bs); ++i) {
+    long count = 0;
+    for (std::size_t j = 0; j < sizeof...(Bs); ++j) {
+      if (!(keys[i] != keys[j]) && (exponents[i] > 0) == (exponents[j] > 0)) {
+        ++count;
+      }
+    }
+    if (count > result.count) {
+      result = {i, count};
+    }
+  }
+  return result;
+}
+
+template <typename Q, typename R>
+struct split_result {
+  using quotient  = Q;
+  using remainder = R;
+};
+
+// Splits the monomials into those divisible by `B^E` divided by it and the rest
+template <typename B, long E, typename Q, typename R>
+constexpr auto split(Q, R, polynomial<>) noexcept {
+  return split_result<Q, R>{};
+}
+
+template <
+    typename B,
+    long E,
+    typename Q,
+    typename R,
+    long C,
+    typename Fs,
+    typename... Ms>
+constexpr auto split(Q q, R r, polynomial<monomial<C, Fs>, Ms...>) noexcept {
+  if constexpr (exponent_of<B>(Fs{}) * E > 0) {
+    using divided = decltype(insert(factor<B, -E>{}, Fs{}));
+    return split<B, E>(
+        insert(monomial<C, divided>{}, q), r, polynomial<Ms...>{}
+    );
+  }
+  else {
+    return split<B, E>(q, insert(monomial<C, Fs>{}, r), polynomial<Ms...>{});
+  }
+}
+
+template <typename T>
+inline constexpr bool is_negation_v = false;
+
+template <typename T>
+inline constexpr bool is_negation_v<negation<T>> = true;
+
+// Returns `l + r` with negations turned into subtractions
+template <typename L, typename R>
+constexpr auto combine(L l, R r) noexcept {
+  if constexpr (is_negation_v<L> && is_negation_v<R>) {
+    return negation(addition(l.arg, r.arg));
+  }
+  else if constexpr (is_negation_v<L>) {
+    return subtraction(r, l.arg);
+  }
+  else if constexpr (is_negation_v<R>) {
+    return subtraction(l, r.arg);
+  }
+  else {
+    return addition(l, r);
+  }
+}
+
+// Returns `B^E * q`
+template <typename B, long E, typename Q>
+constexpr auto pull_out(Q q) noexcept {
+  if constexpr (is_negation_v<Q>) {
+    return negation(pull_out<B, E>(q.arg));
+  }
+  else if constexpr (is_static_constant_v<B>) {
+    return times(constant_power<B, E>(), q);
+  }
+  else if constexpr (E < 0) {
+    return division(q, rebuild(factor<B, -E>{}));
+  }
+  else if constexpr (std::is_same_v<Q, unity>) {
+    return rebuild(factor<B, E>{});
+  }
+  else {
+    return multiplication(rebuild(factor<B, E>{}), q);
+  }
+}
+
+// Returns `B^e Q + R` where `B^e` divides all monomials of `Q`
+template <typename B, long K, typename P>
+constexpr auto horner(P p) noexcept {
+  constexpr long e = common_exponent<B, K>(p);
+  using parts      = decltype(split<B, e>(polynomial<>{}, polynomial<>{}, p));
+  const auto q     = rebuild(typename parts::quotient{});
+  const auto term  = pull_out<B, e>(q);
+  if constexpr (std::is_same_v<typename parts::remainder, polynomial<>>) {
+    return term;
+  }
+  else {
+    return combine(term, rebuild(typename parts::remainder{}));
+  }
+}
+
+template <typename B>
+inline constexpr long variable_index_v = -1;
+
+template <std::size_t N>
+inline constexpr long variable_index_v<variable<N>> = static_cast<long>(N);
+
+// Returns true if the factors are static constants and non-negative powers of a
+// single variable, at least one of them quadratic
+template <typename... Bs, long... Ks>
+constexpr bool is_univariate_polynomial(factors<factor<Bs, Ks>...>) noexcept {
+  constexpr bool constant[] = {is_static_constant_v<Bs>..., true};
+  constexpr long index[]    = {variable_index_v<Bs>..., -1};
+  constexpr long exponent[] = {Ks..., 0};
+  long variable             = -1;
+  long degree               = 0;
+  for (std::size_t i = 0; i < sizeof...(Bs); ++i) {
+    if (constant[i]) {
+      continue;
+    }
+    if (index[i] < 0 || exponent[i] < 0
+        || (variable >= 0 && index[i] != variable)) {
+      return false;
+    }
+    variable = index[i];
+    degree   = exponent[i] > degree ? exponent[i] : degree;
+  }
+  return degree >= 2;
+}
+
+template <long... Cs, typename... Fs>
+constexpr bool
+is_univariate_polynomial(polynomial<monomial<Cs, Fs>...> p) noexcept {
+  return is_univariate_polynomial(all_factors(p));
+}
+
+// Sums in one variable are rebuilt into a single polynomial node. Other sums
+// are rebuilt with a greedy multivariate Horner scheme: The factor shared by
+// most terms is pulled out until no factor is shared by two terms. This
+// reduces the number of evaluations of transcendental functions and divisions.
+template <typename... Ms>
+constexpr auto rebuild(polynomial<Ms...> p) noexcept {
+  if constexpr (sizeof...(Ms) < 2) {
+    return lead_positive(polynomial<>{}, p);
+  }
+  else if constexpr (is_univariate_polynomial(p)) {
+    return polynomial_form(lead_positive(polynomial<>{}, p));
+  }
+  else {
+    using candidates    = decltype(all_factors(p));
+    constexpr auto most = most_common(candidates{});
+    using best          = decltype(element<most.index>(candidates{}));
+    if constexpr (most.count < 2) {
+      return lead_positive(polynomial<>{}, p);
+    }
+    else {
+      return horner<typename best::base, best::exponent>(p);
+    }
+  }
+}
+
+template <typename P>
+using rebuilt_t = decltype(rebuild(P{}));
+
+template <typename P>
+inline constexpr bool is_constant_polynomial_v = false;
+
+template <long C>
+inline constexpr bool
+    is_constant_polynomial_v<polynomial<monomial<C, factors<>>>> = true;
+
+template <typename P>
+inline constexpr long constant_coefficient_v = 0;
+
+template <long C>
+inline constexpr long
+    constant_coefficient_v<polynomial<monomial<C, factors<>>>> = C;
+
+template <typename P>
+constexpr auto as_monomial(P) noexcept {
+  return monomial<1, factors<factor<rebuilt_t<P>, 1>>>{};
+}
+
+template <typename M>
+constexpr auto as_monomial(polynomial<M>) noexcept {
+  return M{};
+}
+
+template <long C, typename Fs, long D, typename Gs>
+constexpr auto multiply(monomial<C, Fs>, monomial<D, Gs>) noexcept {
+  return polynomial<monomial<C * D, decltype(merge(Fs{}, Gs{}))>>{};
+}
+
+// Sums with more than one term are not expanded but kept as a single factor
+template <typename... Ms, typename... Ns>
+constexpr auto multiply(polynomial<Ms...> p, polynomial<Ns...> q) noexcept {
+  using P = polynomial<Ms...>;
+  using Q = polynomial<Ns...>;
+  if constexpr (sizeof...(Ms) == 0 || sizeof...(Ns) == 0) {
+    return polynomial<>{};
+  }
+  else if constexpr (is_constant_polynomial_v<P>) {
+    return scale<constant_coefficient_v<P>>(q);
+  }
+  else if constexpr (is_constant_polynomial_v<Q>) {
+    return scale<constant_coefficient_v<Q>>(p);
+  }
+  else {
+    return multiply(as_monomial(p), as_monomial(q));
+  }
+}
+
+template <typename P>
+constexpr auto reciprocal(P) noexcept {
+  return polynomial<monomial<1, factors<factor<rebuilt_t<P>, -1>>>>{};
+}
+
+template <long C, typename... Bs, long... Ks>
+constexpr auto
+reciprocal(polynomial<monomial<C, factors<factor<Bs, Ks>...>>>) noexcept {
+  using inverse = factors<factor<Bs, -Ks>...>;
+  if constexpr (C == 1 || C == -1) {
+    return polynomial<monomial<C, inverse>>{};
+  }
+  else {
+    constexpr long a = C < 0 ? -C : C;
+    using scaled =
+        decltype(insert(factor<static_constant<a>, -1>{}, inverse{}));
+    return polynomial<monomial<C < 0 ? -1 : 1, scaled>>{};
+  }
+}
+
+template <long K, typename P>
+constexpr auto raise(P p) noexcept {
+  if constexpr (K == 0) {
+    return polynomial<monomial<1, factors<>>>{};
+  }
+  else if constexpr (K < 0) {
+    return reciprocal(raise<-K>(p));
+  }
+  else if constexpr (std::is_same_v<P, polynomial<>>) {
+    return p;
+  }
+  else {
+    return polynomial<monomial<1, factors<factor<rebuilt_t<P>, K>>>>{};
+  }
+}
+
+template <long K, long C, typename... Bs, long... Ks>
+constexpr auto
+raise(polynomial<monomial<C, factors<factor<Bs, Ks>...>>> p) noexcept {
+  if constexpr (K == 0) {
+    return polynomial<monomial<1, factors<>>>{};
+  }
+  else if constexpr (K < 0) {
+    return reciprocal(raise<-K>(p));
+  }
+  else {
+    return polynomial<
+        monomial<integral_power(C, K), factors<factor<Bs, Ks * K>...>>>{};
+  }
+}
+
+template <typename E>
+struct canonical_node {
+  using type = E;
+};
+
+constexpr auto add_all() noexcept { return polynomial<>{}; }
+
+template <typename P, typename... Ps>
+constexpr auto add_all(P p, Ps... ps) noexcept {
+  return add(p, add_all(ps...));
+}
+
+// Returns the terms `Cs[I] x^I` of a polynomial node in `x`
+template <typename X, typename... Cs, std::size_t... Is>
+constexpr auto
+expand_polynomial(univariate<Cs...>, std::index_sequence<Is...>) noexcept {
+  using x = polynomial<monomial<1, factors<factor<X, 1>>>>;
+  return add_all(multiply(to_polynomial(tag<Cs>{}), raise<Is>(x{}))...);
+}
+
+template <typename E>
+constexpr auto to_polynomial(tag<E>) noexcept {
+  if constexpr (is_univariate_v<E>) {
+    using coefficients = typename E::coefficients;
+    using x            = typename canonical_node<operand_t<E, 0>>::type;
+    return expand_polynomial<x>(
+        coefficients{}, std::make_index_sequence<coefficients::degree + 1>{}
+    );
+  }
+  else {
+    using atom = typename canonical_node<E>::type;
+    return polynomial<monomial<1, factors<factor<atom, 1>>>>{};
+  }
+}
+
+template <long N, long D>
+constexpr auto to_polynomial(tag<static_constant<N, D>>) noexcept {
+  if constexpr (N == 0) {
+    return polynomial<>{};
+  }
+  else if constexpr (D == 1) {
+    return polynomial<monomial<N, factors<>>>{};
+  }
+  else {
+    return polynomial<monomial<N, factors<factor<static_constant<D>, -1>>>>{};
+  }
+}
+
+template <typename T>
+constexpr auto to_polynomial(tag<negation<T>>) noexcept {
+  return scale<-1>(to_polynomial(tag<T>{}));
+}
+
+template <typename L, typename R>
+constexpr auto to_polynomial(tag<addition<L, R>>) noexcept {
+  return add(to_polynomial(tag<L>{}), to_polynomial(tag<R>{}));
+}
+
+template <typename L, typename R>
+constexpr auto to_polynomial(tag<subtraction<L, R>>) noexcept {
+  return add(to_polynomial(tag<L>{}), scale<-1>(to_polynomial(tag<R>{})));
+}
+
+template <typename L, typename R>
+constexpr auto to_polynomial(tag<multiplication<L, R>>) noexcept {
+  return multiply(to_polynomial(tag<L>{}), to_polynomial(tag<R>{}));
+}
+
+template <typename L, typename R>
+constexpr auto to_polynomial(tag<division<L, R>>) noexcept {
+  return multiply(to_polynomial(tag<L>{}), reciprocal(to_polynomial(tag<R>{})));
+}
+
+template <typename L, long K>
+constexpr auto to_polynomial(tag<power<L, static_constant<K>>>) noexcept {
+  return raise<K>(to_polynomial(tag<L>{}));
+}
+
+template <typename E>
+using canonical_t = rebuilt_t<decltype(to_polynomial(tag<E>{}))>;
+
+template <template <typename> typename F, typename T>
+struct canonical_node<F<T>> {
+  using type = F<canonical_t<T>>;
+};
+
+template <template <typename, typename> typename F, typename L, typename R>
+struct canonical_node<F<L, R>> {
+  using type = F<canonical_t<L>, canonical_t<R>>;
+};
+
+template <template <typename> typename F, typename T, typename U>
+constexpr auto rebind(const F<T>&, U arg) noexcept {
+  return F<U>(arg);
+}
+
+template <
+    template <typename, typename>
+    typename F,
+    typename L,
+    typename R,
+    typename U,
+    typename V>
+constexpr auto rebind(const F<L, R>&, U lhs, V rhs) noexcept {
+  return F<U, V>(lhs, rhs);
+}
+
+// Returns `expr` in canonical form. Expressions containing runtime constants
+// keep their structure and only their static subexpressions are rewritten.
+template <typename E>
+constexpr auto canonicalize([[maybe_unused]] const E& expr) noexcept {
+  if constexpr (is_static_v<E>) {
+    return make_static<canonical_t<E>>();
+  }
+  else if constexpr (is_unary_v<E>) {
+    return rebind(expr, canonicalize(expr.arg));
+  }
+  else if constexpr (is_binary_v<E>) {
+    return rebind(expr, canonicalize(expr.lhs), canonicalize(expr.rhs));
+  }
+  else {
+    return expr;
+  }
+}
+
+// Number of elements of a range whose size is known at compile time, or zero
+template <typename T, typename = void>
+inline constexpr std::size_t static_size_v = std::extent_v<T>;
+
+template <typename T>
+inline constexpr std::size_t
+    static_size_v<T, std::void_t<decltype(std::tuple_size<T>::value)>> =
+        std::tuple_size_v<T>;
+
+// Evaluates `expr` at the arguments stored contiguously in `xs`, e.g. in a
+// `std::array` or `std::vector`, where the `I`th element is the value of
+// `variable<I>`
+template <typename E, typename Range>
+constexpr auto evaluate(const E& expr, const Range& xs) noexcept {
+  using std::data;
+  using S = std::remove_cv_t<std::remove_pointer_t<decltype(data(xs))>>;
+  static_assert(
+      static_size_v<Range> == 0 || static_size_v<Range> >= arity_v<E>,
+      "Too few arguments passed!"
+  );
+  return expr(context<S>{data(xs)});
+}
+
+constexpr long parse_integral(const char* s) noexcept {
+  long res = 0;
+  for (; *s; ++s) {
+    res *= 10;
+    res += *s - '0';
+  }
+  return res;
+}
+} // namespace detail
+
+inline namespace literals {
+constexpr auto operator""_c(long double x) noexcept {
+  return detail::runtime_constant{static_cast<double>(x)};
+}
+
+template <char... cs>
+constexpr auto operator""_c() noexcept {
+  constexpr const char s[] = {cs..., 0};
+  return detail::static_constant<detail::parse_integral(s)>{};
+}
+} // namespace literals
+
+using detail::runtime_constant;
+using detail::static_constant;
+using detail::variable;
+
+using detail::canonicalize;
+using detail::context;
+using detail::evaluate;
+
+using detail::acos;
+using detail::acosh;
+using detail::asin;
+using detail::asinh;
+using detail::atan;
+using detail::atanh;
+using detail::cos;
+using detail::cosh;
+using detail::exp;
+using detail::log;
+using detail::pow;
+using detail::sin;
+using detail::sinh;
+using detail::sqrt;
+using detail::tan;
+using detail::tanh;
+
+inline namespace variables {
+inline constexpr variable<0> _0;
+inline constexpr variable<1> _1;
+inline constexpr variable<2> _2;
+inline constexpr variable<3> _3;
+inline constexpr variable<4> _4;
+inline constexpr variable<5> _5;
+inline constexpr variable<6> _6;
+inline constexpr variable<7> _7;
+inline constexpr variable<8> _8;
+inline constexpr variable<9> _9;
+
+template <std::size_t N>
+inline constexpr variable<N> var;
 } // namespace variables
 
 } // namespace ad
@@ -0,0 +1,202 @@
+#ifndef AUTOMATICDIFFERENTIATION_BATCH_HH_1729162813394471053_
+#define AUTOMATICDIFFERENTIATION_BATCH_HH_1729162813394471053_
+
+#include "ad.hh"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+namespace ad {
+namespace detail {
+// Number of points that are evaluated per walk of the expression tree. Every
+// binary node keeps one block of this size on the stack, and every fused
+// multiply-add two.
+inline constexpr std::size_t batch_size = 64;
+
+template <typename S, std::size_t N>
+using batch_inputs = std::array<const S*, N>;
+
+template <typename S>
+struct broadcast {
+  S value;
+};
+
+struct batch_impl {
+  template <typename E, typename S, std::size_t N>
+  static void
+  eval(const E& x, const batch_inputs<S, N>& inputs, std::size_t n, S* out) {
+    if constexpr (is_constant_v<E>) {
+      const auto value = static_cast<S>(x.value());
+      for (std::size_t i = 0; i < n; ++i) {
+        out[i] = value;
+      }
+    }
+    else {
+      const S* const values = operand(x, inputs, n, out);
+      if (values != out) {
+        for (std::size_t i = 0; i < n; ++i) {
+          out[i] = values[i];
+        }
+      }
+    }
+  }
+
+private:
+  template <typename S>
+  static constexpr S at(const broadcast<S>& x, std::size_t) noexcept {
+    return x.value;
+  }
+
+  template <typename S>
+  static constexpr S at(const S* values, std::size_t i) noexcept {
+    return values[i];
+  }
+
+  // Returns the values of `x` for the current block. Constants are returned
+  // as a scalar and variables as a pointer into the inputs so neither is
+  // materialized. Everything else is computed into `buffer`.
+  template <typename E, typename S, std::size_t N>
+  static auto operand(
+      const E& x, const batch_inputs<S, N>& inputs, std::size_t n, S* buffer
+  ) {
+    if constexpr (is_constant_v<E>) {
+      return broadcast<S>{static_cast<S>(x.value())};
+    }
+    else if constexpr (is_variable_v<E>) {
+      static_assert(
+          E::value < N,
+          "Too few arguments passed! Maybe you meant to use ad::_0 "
+          "instead of ad::_1."
+      );
+      return inputs[E::value];
+    }
+    else {
+      compute(x, inputs, n, buffer);
+      return static_cast<const S*>(buffer);
+    }
+  }
+
+  template <
+      template <typename>
+      typename F,
+      typename T,
+      typename S,
+      std::size_t N>
+  static void compute(
+      const F<T>& x, const batch_inputs<S, N>& inputs, std::size_t n, S* out
+  ) {
+    const auto args = operand(x.arg, inputs, n, out);
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = F<T>::apply(at(args, i));
+    }
+  }
+
+  template <
+      template <typename, typename>
+      typename Op,
+      typename L,
+      typename R,
+      typename S,
+      std::size_t N>
+  static void compute(
+      const Op<L, R>& x,
+      const batch_inputs<S, N>& inputs,
+      std::size_t n,
+      S* out
+  ) {
+    S buffer[batch_size];
+    if constexpr (is_fused_v<Op<L, R>>) {
+      using operands = fused_operands<Op<L, R>>;
+      S other_buffer[batch_size];
+      const auto [lhs, rhs] =
+          operands_of(operands::product_of(x), inputs, n, out, buffer);
+      const auto other =
+          operand(operands::other_of(x), inputs, n, other_buffer);
+      for (std::size_t i = 0; i < n; ++i) {
+        out[i] = Op<L, R>::fused(at(lhs, i), at(rhs, i), at(other, i));
+      }
+    }
+    else {
+      if constexpr (std::is_same_v<Op<L, R>, division<L, runtime_constant>>) {
+        if (x.reciprocal.value != 0) {
+          const auto lhs = operand(x.lhs, inputs, n, out);
+          const S k      = static_cast<S>(x.reciprocal.value);
+          for (std::size_t i = 0; i < n; ++i) {
+            out[i] = at(lhs, i) * k;
+          }
+          return;
+        }
+      }
+      const auto [lhs, rhs] = operands_of(x, inputs, n, out, buffer);
+      for (std::size_t i = 0; i < n; ++i) {
+        out[i] = Op<L, R>::apply(at(lhs, i), at(rhs, i));
+      }
+    }
+  }
+
+  // Returns the values of both operands of `x`. Equal operands, as in `x * x`,
+  // are computed once.
+  template <
+      template <typename, typename>
+      typename Op,
+      typename L,
+      typename R,
+      typename S,
+      std::size_t N>
+  static auto operands_of(
+      const Op<L, R>& x,
+      const batch_inputs<S, N>& inputs,
+      std::size_t n,
+      S* lhs_buffer,
+      S* rhs_buffer
+  ) {
+    const auto lhs = operand(x.lhs, inputs, n, lhs_buffer);
+    if constexpr (is_static_same_v<L, R>) {
+      return std::pair(lhs, lhs);
+    }
+    else {
+      return std::pair(lhs, operand(x.rhs, inputs, n, rhs_buffer));
+    }
+  }
+};
+
+template <typename E, typename Args, std::size_t... Is>
+void eval_impl(const E& expr, Args args, std::index_sequence<Is...>) {
+  auto& out       = std::get<sizeof...(Is)>(args);
+  using S         = std::remove_pointer_t<decltype(std::data(out))>;
+  const auto size = std::size(out);
+  S* const dst    = std::data(out);
+  assert(((std::size(std::get<Is>(args)) >= size) && ...));
+
+  for (std::size_t offset = 0; offset < size; offset += batch_size) {
+    const std::size_t n = std::min(batch_size, size - offset);
+    const batch_inputs<S, sizeof...(Is)> inputs{
+        (std::data(std::get<Is>(args)) + offset)...};
+    batch_impl::eval(expr, inputs, n, dst + offset);
+  }
+}
+} // namespace detail
+
+// Evaluates `expr` for every point of the input ranges and writes the results
+// to the last range, e.g. `ad::eval(f, xs, ys, out)`. The ranges can be any
+// contiguous containers such as `std::vector` or `std::span` of the same
+// scalar type. Input ranges must be at least as long as the output range.
+template <
+    typename E,
+    typename... Ranges,
+    std::enable_if_t<detail::is_expression_v<E>>* = nullptr>
+void eval(const E& expr, Ranges&&... ranges) {
+  static_assert(sizeof...(Ranges) > 0, "No output range passed!");
+  detail::eval_impl(
+      expr,
+      std::forward_as_tuple(ranges...),
+      std::make_index_sequence<sizeof...(Ranges) - 1>{}
+  );
+}
+} // namespace ad
+
+#endif // AUTOMATICDIFFERENTIATION_BATCH_HH_1729162813394471053_
@@ -0,0 +1,357 @@
+#ifndef AUTOMATICDIFFERENTIATION_CSE_HH_1729165527815332097_
+#define AUTOMATICDIFFERENTIATION_CSE_HH_1729165527815332097_
+
+#include "ad.hh"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <utility>
+
+namespace ad {
+namespace detail {
+template <typename... Ts>
+struct type_list {
+  inline static constexpr std::size_t size = sizeof...(Ts);
+};
+
+template <typename T, typename List>
+inline constexpr bool contains_v = false;
+
+template <typename T, typename... Ts>
+inline constexpr bool contains_v<T, type_list<Ts...>> =
+    std::disjunction_v<std::is_same<T, Ts>...>;
+
+template <typename T, typename List>
+struct index_of;
+
+template <typename T, typename... Ts>
+struct index_of<T, type_list<T, Ts...>>
+    : std::integral_constant<std::size_t, 0> {};
+
+template <typename T, typename U, typename... Ts>
+struct index_of<T, type_list<U, Ts...>>
+    : std::integral_constant<
+          std::size_t,
+          1 + index_of<T, type_list<Ts...>>::value> {};
+
+template <typename T, typename List>
+inline constexpr std::size_t index_of_v = index_of<T, List>::value;
+
+template <std::size_t I, typename List>
+struct type_at;
+
+template <std::size_t I, typename T, typename... Ts>
+struct type_at<I, type_list<T, Ts...>> : type_at<I - 1, type_list<Ts...>> {};
+
+template <typename T, typename... Ts>
+struct type_at<0, type_list<T, Ts...>> {
+  using type = T;
+};
+
+template <std::size_t I, typename List>
+using type_at_t = typename type_at<I, List>::type;
+
+template <typename E, typename Seen>
+struct append_unique {
+  using type = Seen;
+};
+
+template <typename E, typename... Ts>
+struct append_unique<E, type_list<Ts...>> {
+  using type = std::conditional_t<
+      is_static_v<E> && !contains_v<E, type_list<Ts...>>,
+      type_list<Ts..., E>,
+      type_list<Ts...>>;
+};
+
+// Collects the distinct static subexpressions of `E` that are not leaves in
+// post-order, i.e. every subexpression appears after its operands.
+template <typename E, typename Seen>
+struct collect_subexpressions {
+  using type = Seen;
+};
+
+template <template <typename> typename F, typename T, typename Seen>
+struct collect_subexpressions<F<T>, Seen> {
+  using type = typename append_unique<
+      F<T>,
+      typename collect_subexpressions<T, Seen>::type>::type;
+};
+
+template <typename E, typename Seen>
+struct collect_subexpressions<constant_function<E>, Seen> {
+  using type = Seen;
+};
+
+template <
+    template <typename, typename>
+    typename Op,
+    typename L,
+    typename R,
+    typename Seen>
+struct collect_subexpressions<Op<L, R>, Seen> {
+  using type = typename append_unique<
+      Op<L, R>,
+      typename collect_subexpressions<
+          R,
+          typename collect_subexpressions<L, Seen>::type>::type>::type;
+};
+
+template <typename Seen, typename... Es>
+struct collect_all_subexpressions {
+  using type = Seen;
+};
+
+template <typename Seen, typename E, typename... Es>
+struct collect_all_subexpressions<Seen, E, Es...>
+    : collect_all_subexpressions<
+          typename collect_subexpressions<E, Seen>::type,
+          Es...> {};
+
+// Distinct static subexpressions shared by all of `Es`
+template <typename... Es>
+using subexpressions_t =
+    typename collect_all_subexpressions<type_list<>, Es...>::type;
+
+// Function of the same argument as `Node` that is cheaper to evaluate together
+// with it, or `void`
+template <typename Node>
+struct partner {
+  using type = void;
+};
+
+template <typename T>
+struct partner<sinus<T>> {
+  using type = cosinus<T>;
+};
+
+template <typename T>
+struct partner<cosinus<T>> {
+  using type = sinus<T>;
+};
+
+template <typename T>
+struct partner<sinus_hyperbolicus<T>> {
+  using type = cosinus_hyperbolicus<T>;
+};
+
+template <typename T>
+struct partner<cosinus_hyperbolicus<T>> {
+  using type = sinus_hyperbolicus<T>;
+};
+
+template <typename T>
+struct partner<exponential<T>> {
+  using type = exponential<negation<T>>;
+};
+
+template <typename T>
+struct partner<exponential<negation<T>>> {
+  using type = exponential<T>;
+};
+
+template <typename Node>
+inline constexpr bool is_exponential_v = false;
+
+template <typename T>
+inline constexpr bool is_exponential_v<exponential<T>> = true;
+
+template <typename Node>
+inline constexpr bool is_sinh_v = false;
+
+template <typename T>
+inline constexpr bool is_sinh_v<sinus_hyperbolicus<T>> = true;
+
+template <typename Node>
+inline constexpr bool is_cosh_v = false;
+
+template <typename T>
+inline constexpr bool is_cosh_v<cosinus_hyperbolicus<T>> = true;
+
+template <typename S>
+constexpr S power_of_two(int exponent) noexcept {
+  S result = 1;
+  for (; exponent > 0; --exponent) {
+    result *= 2;
+  }
+  return result;
+}
+
+// Bounds within which `exp(x)` and `1 / exp(x)` are finite and normal, and
+// `s * s` does not overflow, derived from the exponent range of `S`
+template <typename S>
+inline constexpr S exponent_bound_v =
+    S(std::min(-std::numeric_limits<S>::min_exponent,
+               std::numeric_limits<S>::max_exponent)
+      - 1)
+    * S(0.693147180559945309417232121458176568L);
+
+template <typename S>
+inline constexpr S square_bound_v =
+    power_of_two<S>(std::numeric_limits<S>::max_exponent / 2 - 1);
+
+// Returns the values of `Node` and of its partner at the argument `x` of `Node`
+template <typename Node, typename S>
+constexpr std::pair<S, S> evaluate_pair(S x) noexcept {
+  using P = typename partner<Node>::type;
+  if constexpr (std::is_floating_point_v<S> && is_exponential_v<Node>) {
+    // The partner `exp(-x)` is the reciprocal unless that over- or underflows
+    const S e = math<S>::exp(x);
+    if (x > -exponent_bound_v<S> && x < exponent_bound_v<S>) {
+      return {e, S(1) / e};
+    }
+    return {e, P::apply(-x)};
+  }
+  else if constexpr (
+      std::is_floating_point_v<S> && (is_sinh_v<Node> || is_cosh_v<Node>)) {
+    // `cosh(x) = sqrt(1 + sinh(x)^2)` has no cancellation
+    const S s = math<S>::sinh(x);
+    const S c = s > -square_bound_v<S> && s < square_bound_v<S>
+                  ? math<S>::sqrt(S(1) + s * s)
+                  : math<S>::cosh(x);
+    if constexpr (is_sinh_v<Node>) {
+      return {s, c};
+    }
+    else {
+      return {c, s};
+    }
+  }
+  else {
+    // Adjacent calls with the same argument, which compilers merge into one
+    // `sincos` call where available
+    return {Node::apply(x), P::apply(x)};
+  }
+}
+
+// Evaluates expressions whose static subexpressions are a subset of
+// `Subexpressions` after all of those have been computed once by `fill`
+template <typename Subexpressions>
+struct cse_impl {
+  template <typename S>
+  using values_t = std::array<S, Subexpressions::size>;
+
+  template <typename S, typename... Ts>
+  static constexpr values_t<S> fill(Ts... xs) noexcept {
+    values_t<S> values{};
+    fill(values, std::make_index_sequence<Subexpressions::size>{}, xs...);
+    return values;
+  }
+
+  template <typename Node, typename S, typename... Ts>
+  static constexpr S
+  evaluate(const Node& x, const values_t<S>& values, Ts... xs) noexcept {
+    if constexpr (is_static_v<Node>) {
+      return lookup<Node>(values, xs...);
+    }
+    else if constexpr (is_unary_v<Node>) {
+      return Node::apply(evaluate(x.arg, values, xs...));
+    }
+    else if constexpr (is_fused_v<Node>) {
+      using operands      = fused_operands<Node>;
+      const auto& product = operands::product_of(x);
+      return Node::fused(
+          evaluate(product.lhs, values, xs...),
+          evaluate(product.rhs, values, xs...),
+          evaluate(operands::other_of(x), values, xs...)
+      );
+    }
+    else if constexpr (is_binary_v<Node>) {
+      return Node::apply(
+          evaluate(x.lhs, values, xs...), evaluate(x.rhs, values, xs...)
+      );
+    }
+    else {
+      return x(xs...);
+    }
+  }
+
+private:
+  template <typename S, std::size_t... Is, typename... Ts>
+  static constexpr void
+  fill(values_t<S>& values, std::index_sequence<Is...>, Ts... xs) noexcept {
+    (store<type_at_t<Is, Subexpressions>>(values, xs...), ...);
+  }
+
+  // Stores the value of `Node`. If its partner is a subexpression, too, both
+  // are stored together when the first one is reached.
+  template <typename Node, typename S, typename... Ts>
+  static constexpr void store(values_t<S>& values, Ts... xs) noexcept {
+    using P                 = typename partner<Node>::type;
+    constexpr std::size_t i = index_of_v<Node, Subexpressions>;
+    if constexpr (contains_v<P, Subexpressions>) {
+      constexpr std::size_t j = index_of_v<P, Subexpressions>;
+      if constexpr (i < j) {
+        const auto [value, other] = evaluate_pair<Node>(
+            lookup<operand_t<Node, 0>>(values, xs...)
+        );
+        values[i] = value;
+        values[j] = other;
+      }
+    }
+    else {
+      values[i] = compute<Node>(values, xs...);
+    }
+  }
+
+  template <typename Node, typename S, typename... Ts>
+  static constexpr S compute(const values_t<S>& values, Ts... xs) noexcept {
+    if constexpr (is_unary_v<Node>) {
+      return Node::apply(lookup<operand_t<Node, 0>>(values, xs...));
+    }
+    else if constexpr (is_fused_v<Node>) {
+      using operands = fused_operands<Node>;
+      using product  = typename operands::product;
+      return Node::fused(
+          lookup<operand_t<product, 0>>(values, xs...),
+          lookup<operand_t<product, 1>>(values, xs...),
+          lookup<typename operands::other>(values, xs...)
+      );
+    }
+    else {
+      return Node::apply(
+          lookup<operand_t<Node, 0>>(values, xs...),
+          lookup<operand_t<Node, 1>>(values, xs...)
+      );
+    }
+  }
+
+  template <typename Node, typename S, typename... Ts>
+  static constexpr S lookup(const values_t<S>& values, Ts... xs) noexcept {
+    if constexpr (contains_v<Node, Subexpressions>) {
+      return values[index_of_v<Node, Subexpressions>];
+    }
+    else {
+      // Static leaves carry no state and are cheaper to evaluate than to store
+      return Node()(xs...);
+    }
+  }
+};
+
+template <typename E>
+struct cse_expression {
+  AD_NO_UNIQUE_ADDRESS E expr;
+
+  using subexpressions = subexpressions_t<E>;
+
+  template <
+      typename... Ts,
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    using impl        = cse_impl<subexpressions>;
+    const auto values = impl::template fill<scalar_t<Ts...>>(xs...);
+    return impl::evaluate(expr, values, xs...);
+  }
+};
+} // namespace detail
+
+// Wraps `expr` into a callable that evaluates every distinct static
+// subexpression only once per call. This pays off for higher-order
+// derivatives, which repeat large parts of their tree.
+template <typename E, std::enable_if_t<detail::is_expression_v<E>>* = nullptr>
+constexpr auto cse(E expr) noexcept {
+  return detail::cse_expression<E>{expr};
+}
+} // namespace ad
+
+#endif // AUTOMATICDIFFERENTIATION_CSE_HH_1729165527815332097_
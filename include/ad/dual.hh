@@ -0,0 +1,203 @@
+#ifndef AUTOMATICDIFFERENTIATION_DUAL_HH_1729168264119084561_
+#define AUTOMATICDIFFERENTIATION_DUAL_HH_1729168264119084561_
+
+#include "ad.hh"
+
+#include <array>
+#include <utility>
+
+namespace ad {
+// Forward-mode dual number carrying a value and its partial derivatives with
+// respect to `N` variables
+template <typename S, std::size_t N>
+struct dual {
+  S value{};
+  std::array<S, N> gradient{};
+
+  constexpr dual() = default;
+
+  constexpr dual(S x) noexcept : value(x) {}
+
+  constexpr dual(S x, const std::array<S, N>& dx) noexcept
+      : value(x), gradient(dx) {}
+
+  // Returns the dual number of the `I`th of `N` variables at `x`
+  template <std::size_t I>
+  static constexpr dual variable(S x) noexcept {
+    static_assert(I < N);
+    dual result{x};
+    result.gradient[I] = S(1);
+    return result;
+  }
+
+  // Returns `f(*this)` given `f(value)` and `f'(value)`
+  constexpr dual chain(S f, S df) const noexcept {
+    dual result{f};
+    for (std::size_t i = 0; i < N; ++i) {
+      result.gradient[i] = df * gradient[i];
+    }
+    return result;
+  }
+
+  friend constexpr dual operator+(const dual& x) noexcept { return x; }
+
+  friend constexpr dual operator-(const dual& x) noexcept {
+    return x.chain(-x.value, S(-1));
+  }
+
+  friend constexpr dual operator+(const dual& l, const dual& r) noexcept {
+    dual result{l.value + r.value};
+    for (std::size_t i = 0; i < N; ++i) {
+      result.gradient[i] = l.gradient[i] + r.gradient[i];
+    }
+    return result;
+  }
+
+  friend constexpr dual operator-(const dual& l, const dual& r) noexcept {
+    dual result{l.value - r.value};
+    for (std::size_t i = 0; i < N; ++i) {
+      result.gradient[i] = l.gradient[i] - r.gradient[i];
+    }
+    return result;
+  }
+
+  friend constexpr dual operator*(const dual& l, const dual& r) noexcept {
+    dual result{l.value * r.value};
+    for (std::size_t i = 0; i < N; ++i) {
+      result.gradient[i] = l.gradient[i] * r.value + l.value * r.gradient[i];
+    }
+    return result;
+  }
+
+  friend constexpr dual operator/(const dual& l, const dual& r) noexcept {
+    const S inverse = S(1) / r.value;
+    const S value   = l.value * inverse;
+    dual result{value};
+    for (std::size_t i = 0; i < N; ++i) {
+      result.gradient[i] = (l.gradient[i] - value * r.gradient[i]) * inverse;
+    }
+    return result;
+  }
+};
+
+template <typename S, std::size_t N>
+struct math<dual<S, N>> {
+  using T = dual<S, N>;
+
+  static constexpr T exp(const T& x) noexcept {
+    const S e = math<S>::exp(x.value);
+    return x.chain(e, e);
+  }
+
+  static constexpr T log(const T& x) noexcept {
+    return x.chain(math<S>::log(x.value), S(1) / x.value);
+  }
+
+  static constexpr T sqrt(const T& x) noexcept {
+    const S r = math<S>::sqrt(x.value);
+    return x.chain(r, S(0.5) / r);
+  }
+
+  static constexpr T sin(const T& x) noexcept {
+    return x.chain(math<S>::sin(x.value), math<S>::cos(x.value));
+  }
+
+  static constexpr T cos(const T& x) noexcept {
+    return x.chain(math<S>::cos(x.value), -math<S>::sin(x.value));
+  }
+
+  static constexpr T tan(const T& x) noexcept {
+    const S t = math<S>::tan(x.value);
+    return x.chain(t, S(1) + t * t);
+  }
+
+  static constexpr T sinh(const T& x) noexcept {
+    return x.chain(math<S>::sinh(x.value), math<S>::cosh(x.value));
+  }
+
+  static constexpr T cosh(const T& x) noexcept {
+    return x.chain(math<S>::cosh(x.value), math<S>::sinh(x.value));
+  }
+
+  static constexpr T tanh(const T& x) noexcept {
+    const S t = math<S>::tanh(x.value);
+    return x.chain(t, S(1) - t * t);
+  }
+
+  static constexpr T asin(const T& x) noexcept {
+    const S d = S(1) / math<S>::sqrt(S(1) - x.value * x.value);
+    return x.chain(math<S>::asin(x.value), d);
+  }
+
+  static constexpr T acos(const T& x) noexcept {
+    const S d = S(-1) / math<S>::sqrt(S(1) - x.value * x.value);
+    return x.chain(math<S>::acos(x.value), d);
+  }
+
+  static constexpr T atan(const T& x) noexcept {
+    const S d = S(1) / (S(1) + x.value * x.value);
+    return x.chain(math<S>::atan(x.value), d);
+  }
+
+  static constexpr T asinh(const T& x) noexcept {
+    const S d = S(1) / math<S>::sqrt(x.value * x.value + S(1));
+    return x.chain(math<S>::asinh(x.value), d);
+  }
+
+  static constexpr T acosh(const T& x) noexcept {
+    const S d = S(1) / (math<S>::sqrt(x.value - S(1))
+                        * math<S>::sqrt(x.value + S(1)));
+    return x.chain(math<S>::acosh(x.value), d);
+  }
+
+  static constexpr T atanh(const T& x) noexcept {
+    const S d = S(1) / (S(1) - x.value * x.value);
+    return x.chain(math<S>::atanh(x.value), d);
+  }
+
+  static constexpr T pow(const T& x, const T& y) noexcept {
+    const S value = math<S>::pow(x.value, y.value);
+    const S dx    = y.value * math<S>::pow(x.value, y.value - S(1));
+    T result{value};
+    for (std::size_t i = 0; i < N; ++i) {
+      result.gradient[i] = dx * x.gradient[i];
+    }
+    // The logarithm is undefined for non-positive bases, so only evaluate it
+    // if the exponent depends on any variable
+    bool variable_exponent = false;
+    for (std::size_t i = 0; i < N; ++i) {
+      variable_exponent = variable_exponent || y.gradient[i] != S(0);
+    }
+    if (variable_exponent) {
+      const S dy = value * math<S>::log(x.value);
+      for (std::size_t i = 0; i < N; ++i) {
+        result.gradient[i] += dy * y.gradient[i];
+      }
+    }
+    return result;
+  }
+};
+
+namespace detail {
+template <typename S, typename E, typename... Ts, std::size_t... Is>
+constexpr auto
+value_and_gradient_impl(const E& expr, std::index_sequence<Is...>, Ts... xs) {
+  using D = dual<S, sizeof...(Ts)>;
+  return expr(D::template variable<Is>(static_cast<S>(xs))...);
+}
+} // namespace detail
+
+// Evaluates `expr` and all of its partial derivatives at `xs` in a single pass
+// and returns them as `dual` with the members `value` and `gradient`.
+template <
+    typename E,
+    typename... Ts,
+    std::enable_if_t<detail::is_expression_v<E>>* = nullptr>
+constexpr auto value_and_gradient(const E& expr, Ts... xs) noexcept {
+  return detail::value_and_gradient_impl<detail::scalar_t<Ts...>>(
+      expr, std::index_sequence_for<Ts...>{}, xs...
+  );
+}
+} // namespace ad
+
+#endif // AUTOMATICDIFFERENTIATION_DUAL_HH_1729168264119084561_
@@ -0,0 +1,490 @@
+#ifndef AUTOMATICDIFFERENTIATION_FAST_MATH_HH_1729171045662310528_
+#define AUTOMATICDIFFERENTIATION_FAST_MATH_HH_1729171045662310528_
+
+#include "ad.hh"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace ad {
+namespace detail {
+inline std::uint64_t bits_of(double x) noexcept {
+  std::uint64_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  return bits;
+}
+
+inline double from_bits(std::uint64_t bits) noexcept {
+  double x;
+  std::memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+// Returns `condition ? x : y` by masking the bits of both instead of branching.
+// Branches around floating-point operations prevent the vectorization of loops
+// that call these functions.
+inline double select(bool condition, double x, double y) noexcept {
+  const std::uint64_t mask = 0 - static_cast<std::uint64_t>(condition);
+  return from_bits((bits_of(x) & mask) | (bits_of(y) & ~mask));
+}
+
+// Returns `c0 + x * (c1 + x * (c2 + ...))`
+inline double evaluate_polynomial(double, double c) noexcept { return c; }
+
+template <typename... Cs>
+inline double evaluate_polynomial(double x, double c, Cs... cs) noexcept {
+  return c + x * evaluate_polynomial(x, cs...);
+}
+
+// Returns `x * 2^n` for `-2044 <= n <= 2046` in two steps, so that neither
+// factor over- or underflows on its own
+inline double scale_exponent(double x, std::int64_t n) noexcept {
+  const std::int64_t half = n / 2;
+  const auto first  = static_cast<std::uint64_t>(half + 1023) << 52;
+  const auto second = static_cast<std::uint64_t>(n - half + 1023) << 52;
+  return x * from_bits(first) * from_bits(second);
+}
+
+inline constexpr double ln2_hi = 0x1.62e42fee00000p-1;
+inline constexpr double ln2_lo = 0x1.a39ef35793c76p-33;
+
+// `exp(x) = p * 2^n` with `|log(p)| <= log(2) / 2`
+struct exp_parts {
+  double p;
+  std::int64_t n;
+};
+
+inline exp_parts fast_exp_parts(double x) noexcept {
+  // Clamping keeps `n` in the range of `scale_exponent` and leaves NaN
+  const double y = select(x > 711.0, 711.0, select(x < -746.0, -746.0, x));
+  // Adding `1.5 * 2^52` rounds to the nearest integer, which is then stored in
+  // the low bits of the mantissa
+  constexpr double shift = 0x1.8p52;
+  const double t         = y * 0x1.71547652b82fep0 + shift;
+  const double k         = t - shift;
+  const double r         = (y - k * ln2_hi) - k * ln2_lo;
+  const double p         = evaluate_polynomial(
+      r,
+      1.0,
+      1.0,
+      1.0 / 2,
+      1.0 / 6,
+      1.0 / 24,
+      1.0 / 120,
+      1.0 / 720,
+      1.0 / 5040,
+      1.0 / 40320,
+      1.0 / 362880,
+      1.0 / 3628800,
+      1.0 / 39916800,
+      1.0 / 479001600,
+      1.0 / 6227020800
+  );
+  return {p, static_cast<std::int64_t>(bits_of(t) - bits_of(shift))};
+}
+
+inline double fast_exp(double x) noexcept {
+  const auto [p, n] = fast_exp_parts(x);
+  return scale_exponent(p, n);
+}
+
+// Returns `log(1 + f) - f` for `sqrt(1/2) - 1 <= f < sqrt(2) - 1`
+inline double log1p_tail(double f) noexcept {
+  const double s    = f / (2.0 + f);
+  const double z    = s * s;
+  const double hfsq = 0.5 * f * f;
+  const double r    = z
+                   * evaluate_polynomial(
+                         z,
+                         2.0 / 3,
+                         2.0 / 5,
+                         2.0 / 7,
+                         2.0 / 9,
+                         2.0 / 11,
+                         2.0 / 13,
+                         2.0 / 15,
+                         2.0 / 17,
+                         2.0 / 19,
+                         2.0 / 21,
+                         2.0 / 23
+                   );
+  return s * (hfsq + r) - hfsq;
+}
+
+inline double fast_log(double x) noexcept {
+  // Subnormals are scaled into the normal range first. The exponent of the
+  // scale factor is subtracted again below.
+  const double factor = select(x < 0x1p-1022, 0x1p54, 1.0);
+  const auto bits     = bits_of(x * factor);
+  // Split `x * factor = m * 2^e` with `sqrt(1/2) <= m < sqrt(2)`
+  constexpr std::uint64_t offset = 0x3fe6a09e667f3bcd;
+  const std::int64_t e = static_cast<std::int64_t>(bits - offset) >> 52;
+  const double m = from_bits(bits - (static_cast<std::uint64_t>(e) << 52));
+  const auto n = static_cast<std::uint64_t>(e) - (bits_of(factor) >> 52);
+  // `k = n + 1023` through the mantissa of `1.5 * 2^52`, since AVX2 has no
+  // vector conversion from 64-bit integers
+  const double k = from_bits(bits_of(0x1.8p52) + n + 1023) - 0x1.8p52;
+  const double f = m - 1.0;
+  const double result = k * ln2_hi + (f + (log1p_tail(f) + k * ln2_lo));
+  constexpr double infinity = std::numeric_limits<double>::infinity();
+  // Separate selects for infinity and NaN, zero and negative arguments
+  const double finite   = select(x < infinity, result, x);
+  const double positive = select(x == 0.0, -infinity, finite);
+  return select(x < 0.0, std::numeric_limits<double>::quiet_NaN(), positive);
+}
+
+// Returns `log(1 + x)` for `x > -1`
+inline double fast_log1p(double x) noexcept {
+  // The rounding error of `1 + x` is corrected to first order
+  const double u          = 1.0 + x;
+  const double correction = (x - (u - 1.0)) / u;
+  return fast_log(u)
+         + select(u < std::numeric_limits<double>::infinity(), correction, 0.0);
+}
+
+// `x = k * pi / 2 + r` with `|r| <= pi / 4`, accurate for `|x| <= 2^20 pi / 2`
+struct quadrant_parts {
+  double r;
+  std::uint64_t k;
+};
+
+inline quadrant_parts reduce_quadrant(double x) noexcept {
+  constexpr double shift = 0x1.8p52;
+  const double t         = x * 0x1.45f306dc9c883p-1 + shift;
+  const double k         = t - shift;
+  // pi / 2 in three parts, the first two with 33 significant bits
+  const double r = ((x - k * 0x1.921fb54400000p0) - k * 0x1.0b4611a600000p-34)
+                   - k * 0x1.3198a2e037073p-69;
+  return {r, bits_of(t) - bits_of(shift)};
+}
+
+inline double sin_kernel(double r) noexcept {
+  const double z = r * r;
+  return r
+         + r * z
+               * evaluate_polynomial(
+                   z,
+                   -1.0 / 6,
+                   1.0 / 120,
+                   -1.0 / 5040,
+                   1.0 / 362880,
+                   -1.0 / 39916800,
+                   1.0 / 6227020800,
+                   -1.0 / 1307674368000,
+                   1.0 / 355687428096000,
+                   -1.0 / 121645100408832000
+               );
+}
+
+inline double cos_kernel(double r) noexcept {
+  const double z  = r * r;
+  const double hz = 0.5 * z;
+  const double w  = 1.0 - hz;
+  // `1 - hz` is exact up to the rounding of `w`, which is added back
+  return w
+         + (((1.0 - w) - hz)
+            + z * z
+                  * evaluate_polynomial(
+                      z,
+                      1.0 / 24,
+                      -1.0 / 720,
+                      1.0 / 40320,
+                      -1.0 / 3628800,
+                      1.0 / 479001600,
+                      -1.0 / 87178291200,
+                      1.0 / 20922789888000,
+                      -1.0 / 6402373705728000
+                  ));
+}
+
+inline double fast_sin(double x) noexcept {
+  const auto [r, k] = reduce_quadrant(x);
+  const double s    = sin_kernel(r);
+  const double c    = cos_kernel(r);
+  const double v    = select(k & 1, c, s);
+  return from_bits(bits_of(v) ^ ((k & 2) << 62));
+}
+
+inline double fast_cos(double x) noexcept {
+  const auto [r, k] = reduce_quadrant(x);
+  const double s    = sin_kernel(r);
+  const double c    = cos_kernel(r);
+  const double v    = select(k & 1, s, c);
+  return from_bits(bits_of(v) ^ (((k + 1) & 2) << 62));
+}
+
+inline double fast_tan(double x) noexcept {
+  const auto [r, k] = reduce_quadrant(x);
+  const double s    = sin_kernel(r);
+  const double c    = cos_kernel(r);
+  return select(k & 1, -c / s, s / c);
+}
+
+// Returns `sinh(x)` for `|x| <= 1`
+inline double sinh_kernel(double x) noexcept {
+  const double z = x * x;
+  return x
+         + x * z
+               * evaluate_polynomial(
+                   z,
+                   1.0 / 6,
+                   1.0 / 120,
+                   1.0 / 5040,
+                   1.0 / 362880,
+                   1.0 / 39916800,
+                   1.0 / 6227020800,
+                   1.0 / 1307674368000,
+                   1.0 / 355687428096000,
+                   1.0 / 121645100408832000
+               );
+}
+
+inline double fast_sinh(double x) noexcept {
+  const double a    = std::fabs(x);
+  const auto [p, n] = fast_exp_parts(a);
+  const double large =
+      scale_exponent(p, n - 1) - scale_exponent(1.0 / p, -n - 1);
+  return std::copysign(select(a < 1.0, sinh_kernel(a), large), x);
+}
+
+inline double fast_cosh(double x) noexcept {
+  const auto [p, n] = fast_exp_parts(std::fabs(x));
+  return scale_exponent(p, n - 1) + scale_exponent(1.0 / p, -n - 1);
+}
+
+inline double fast_tanh(double x) noexcept {
+  const double a     = std::fabs(x);
+  const double s     = sinh_kernel(a);
+  const double small = s / std::sqrt(1.0 + s * s);
+  const double large = 1.0 - 2.0 / (fast_exp(2.0 * a) + 1.0);
+  return std::copysign(select(a < 0.625, small, large), x);
+}
+
+inline double fast_atan(double x) noexcept {
+  // atan(a) = pi / 2 - atan(1 / a) reduces to `[0, 1]` and
+  // atan(u) = pi / 4 + atan((u - 1) / (u + 1)) further to `|v| <= tan(pi / 8)`
+  const double a      = std::fabs(x);
+  const bool inverted = a > 1.0;
+  const double u      = select(inverted, 1.0 / a, a);
+  const bool shifted  = u > 0x1.a827999fcef32p-2;
+  const double v      = select(shifted, (u - 1.0) / (u + 1.0), u);
+  const double z      = v * v;
+  const double w      = v
+                   + v * z
+                         * evaluate_polynomial(
+                             z,
+                             -1.0 / 3,
+                             1.0 / 5,
+                             -1.0 / 7,
+                             1.0 / 9,
+                             -1.0 / 11,
+                             1.0 / 13,
+                             -1.0 / 15,
+                             1.0 / 17,
+                             -1.0 / 19,
+                             1.0 / 21,
+                             -1.0 / 23,
+                             1.0 / 25,
+                             -1.0 / 27,
+                             1.0 / 29,
+                             -1.0 / 31,
+                             1.0 / 33,
+                             -1.0 / 35,
+                             1.0 / 37,
+                             -1.0 / 39,
+                             1.0 / 41
+                         );
+  constexpr double pi_4    = 0x1.921fb54442d18p-1;
+  constexpr double pi_4_lo = 0x1.1a62633145c07p-55;
+  const double t = select(shifted, pi_4 + (w + pi_4_lo), w);
+  const double result = select(inverted, 2 * pi_4 - (t - 2 * pi_4_lo), t);
+  return std::copysign(result, x);
+}
+
+inline double fast_asin(double x) noexcept {
+  return fast_atan(x / std::sqrt((1.0 - x) * (1.0 + x)));
+}
+
+inline double fast_acos(double x) noexcept {
+  return 2.0 * fast_atan(std::sqrt((1.0 - x) / (1.0 + x)));
+}
+
+inline double fast_asinh(double x) noexcept {
+  const double a     = std::fabs(x);
+  const double small = fast_log1p(a + a * a / (1.0 + std::sqrt(1.0 + a * a)));
+  const double large = fast_log(a) + 0x1.62e42fefa39efp-1;
+  return std::copysign(select(a < 0x1p28, small, large), x);
+}
+
+inline double fast_acosh(double x) noexcept {
+  const double t     = x - 1.0;
+  const double small = fast_log1p(t + std::sqrt(2.0 * t + t * t));
+  const double large = fast_log(x) + 0x1.62e42fefa39efp-1;
+  return select(
+      x < 1.0,
+      std::numeric_limits<double>::quiet_NaN(),
+      select(x < 0x1p28, small, large)
+  );
+}
+
+inline double fast_atanh(double x) noexcept {
+  const double a = std::fabs(x);
+  return std::copysign(0.5 * fast_log1p(2.0 * a / (1.0 - a)), x);
+}
+} // namespace detail
+
+// Scalar that evaluates the elementary functions with the branch-free
+// approximations above instead of the standard library, e.g. `f(ad::fast(x))`.
+// They vectorize in batched evaluation and have a maximum error in units in the
+// last place (ulp) of a `double` result of
+//
+//   exp  2    sinh  2    asin   4    asinh  3
+//   log  1    cosh  2    acos   3    acosh  3
+//   sin  3    tanh  3    atan   3    atanh  3
+//   cos  3    sqrt  0.5
+//   tan  4
+//
+// as measured against `long double`. `float` is computed in `double` and
+// rounded once, to an error below 1 ulp. Results for `|x| > 2^20 * pi / 2` of
+// `sin`, `cos` and `tan` are inaccurate, `pow` with a runtime exponent uses
+// `math<T>::pow`.
+template <typename T>
+struct fast {
+  static_assert(
+      std::is_same_v<T, float> || std::is_same_v<T, double>,
+      "ad::fast supports float and double!"
+  );
+
+  T value{};
+
+  constexpr fast() = default;
+
+  constexpr fast(T x) noexcept : value(x) {}
+
+  template <typename U, std::enable_if_t<std::is_arithmetic_v<U>>* = nullptr>
+  constexpr fast(U x) noexcept : value(static_cast<T>(x)) {}
+
+  constexpr explicit operator T() const noexcept { return value; }
+
+  friend constexpr fast operator+(fast x) noexcept { return x; }
+
+  friend constexpr fast operator-(fast x) noexcept { return -x.value; }
+
+  friend constexpr fast operator+(fast l, fast r) noexcept {
+    return l.value + r.value;
+  }
+
+  friend constexpr fast operator-(fast l, fast r) noexcept {
+    return l.value - r.value;
+  }
+
+  friend constexpr fast operator*(fast l, fast r) noexcept {
+    return l.value * r.value;
+  }
+
+  friend constexpr fast operator/(fast l, fast r) noexcept {
+    return l.value / r.value;
+  }
+
+  constexpr fast& operator+=(fast x) noexcept { return *this = *this + x; }
+
+  constexpr fast& operator-=(fast x) noexcept { return *this = *this - x; }
+
+  constexpr fast& operator*=(fast x) noexcept { return *this = *this * x; }
+
+  constexpr fast& operator/=(fast x) noexcept { return *this = *this / x; }
+
+  friend constexpr bool operator==(fast l, fast r) noexcept {
+    return l.value == r.value;
+  }
+
+  friend constexpr bool operator!=(fast l, fast r) noexcept {
+    return l.value != r.value;
+  }
+
+  friend constexpr bool operator<(fast l, fast r) noexcept {
+    return l.value < r.value;
+  }
+
+  friend constexpr bool operator>(fast l, fast r) noexcept {
+    return l.value > r.value;
+  }
+
+  friend constexpr bool operator<=(fast l, fast r) noexcept {
+    return l.value <= r.value;
+  }
+
+  friend constexpr bool operator>=(fast l, fast r) noexcept {
+    return l.value >= r.value;
+  }
+};
+
+template <typename T>
+fast(T) -> fast<T>;
+
+template <typename T>
+struct math<fast<T>> {
+  static fast<T> exp(fast<T> x) noexcept { return call<detail::fast_exp>(x); }
+
+  static fast<T> log(fast<T> x) noexcept { return call<detail::fast_log>(x); }
+
+  static fast<T> sqrt(fast<T> x) noexcept { return std::sqrt(x.value); }
+
+  static fast<T> sin(fast<T> x) noexcept { return call<detail::fast_sin>(x); }
+
+  static fast<T> cos(fast<T> x) noexcept { return call<detail::fast_cos>(x); }
+
+  static fast<T> tan(fast<T> x) noexcept { return call<detail::fast_tan>(x); }
+
+  static fast<T> sinh(fast<T> x) noexcept {
+    return call<detail::fast_sinh>(x);
+  }
+
+  static fast<T> cosh(fast<T> x) noexcept {
+    return call<detail::fast_cosh>(x);
+  }
+
+  static fast<T> tanh(fast<T> x) noexcept {
+    return call<detail::fast_tanh>(x);
+  }
+
+  static fast<T> asin(fast<T> x) noexcept {
+    return call<detail::fast_asin>(x);
+  }
+
+  static fast<T> acos(fast<T> x) noexcept {
+    return call<detail::fast_acos>(x);
+  }
+
+  static fast<T> atan(fast<T> x) noexcept {
+    return call<detail::fast_atan>(x);
+  }
+
+  static fast<T> asinh(fast<T> x) noexcept {
+    return call<detail::fast_asinh>(x);
+  }
+
+  static fast<T> acosh(fast<T> x) noexcept {
+    return call<detail::fast_acosh>(x);
+  }
+
+  static fast<T> atanh(fast<T> x) noexcept {
+    return call<detail::fast_atanh>(x);
+  }
+
+  static fast<T> pow(fast<T> x, fast<T> y) noexcept {
+    return math<T>::pow(x.value, y.value);
+  }
+
+private:
+  template <double (*F)(double)>
+  static fast<T> call(fast<T> x) noexcept {
+    return static_cast<T>(F(x.value));
+  }
+};
+} // namespace ad
+
+#endif // AUTOMATICDIFFERENTIATION_FAST_MATH_HH_1729171045662310528_
@@ -0,0 +1,284 @@
+#ifndef AUTOMATICDIFFERENTIATION_FUNCTION_HH_1729181467203518837_
+#define AUTOMATICDIFFERENTIATION_FUNCTION_HH_1729181467203518837_
+
+#include "ad.hh"
+#include "batch.hh"
+#include "reverse.hh"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <utility>
+
+namespace ad {
+namespace detail {
+// Operations of a `function` on the expression it stores. The storage holds
+// either the expression itself or a pointer to it if it is too large.
+template <std::size_t N>
+struct function_vtable {
+  double (*evaluate)(const void* storage, const double* xs) noexcept;
+  void (*eval)(
+      const void* storage,
+      const batch_inputs<double, N>& inputs,
+      std::size_t n,
+      double* out
+  );
+  void (*gradient)(
+      const void* storage,
+      const batch_inputs<double, N>& inputs,
+      std::size_t n,
+      double* values,
+      double* gradients
+  );
+  void (*copy)(const void* storage, void* destination);
+  void (*move)(void* storage, void* destination) noexcept;
+  void (*destroy)(void* storage) noexcept;
+};
+
+template <typename E, std::size_t N, std::size_t Capacity>
+struct function_model {
+  inline static constexpr bool is_inline =
+      sizeof(E) <= Capacity && alignof(E) <= alignof(std::max_align_t);
+
+  static const E& get(const void* storage) noexcept {
+    if constexpr (is_inline) {
+      return *std::launder(static_cast<const E*>(storage));
+    }
+    else {
+      return **std::launder(static_cast<E* const*>(storage));
+    }
+  }
+
+  static void create(void* storage, const E& expr) {
+    if constexpr (is_inline) {
+      ::new (storage) E(expr);
+    }
+    else {
+      ::new (storage) E*(new E(expr));
+    }
+  }
+
+  static double evaluate(const void* storage, const double* xs) noexcept {
+    return get(storage)(context<double>{xs});
+  }
+
+  static void eval(
+      const void* storage,
+      const batch_inputs<double, N>& inputs,
+      std::size_t n,
+      double* out
+  ) {
+    const E& expr = get(storage);
+    for (std::size_t offset = 0; offset < n; offset += batch_size) {
+      batch_inputs<double, N> block = inputs;
+      for (auto& input : block) {
+        input += offset;
+      }
+      batch_impl::eval(
+          expr, block, std::min(batch_size, n - offset), out + offset
+      );
+    }
+  }
+
+  static void gradient(
+      const void* storage,
+      const batch_inputs<double, N>& inputs,
+      std::size_t n,
+      double* values,
+      double* gradients
+  ) {
+    gradient_of(
+        get(storage),
+        inputs,
+        n,
+        values,
+        gradients,
+        std::make_index_sequence<N>{}
+    );
+  }
+
+  template <std::size_t... Is>
+  static void gradient_of(
+      const E& expr,
+      const batch_inputs<double, N>& inputs,
+      std::size_t n,
+      double* values,
+      double* gradients,
+      std::index_sequence<Is...>
+  ) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto result = reverse_gradient<double>(expr, inputs[Is][i]...);
+      values[i]         = result.value;
+      for (std::size_t j = 0; j < N; ++j) {
+        gradients[i * N + j] = result.gradient[j];
+      }
+    }
+  }
+
+  static void copy(const void* storage, void* destination) {
+    create(destination, get(storage));
+  }
+
+  static void move(void* storage, void* destination) noexcept {
+    if constexpr (is_inline) {
+      E& expr = *std::launder(static_cast<E*>(storage));
+      ::new (destination) E(std::move(expr));
+      destroy(storage);
+    }
+    else {
+      ::new (destination) E*(*std::launder(static_cast<E**>(storage)));
+    }
+  }
+
+  static void destroy(void* storage) noexcept {
+    if constexpr (is_inline) {
+      std::launder(static_cast<E*>(storage))->~E();
+    }
+    else {
+      delete *std::launder(static_cast<E**>(storage));
+    }
+  }
+
+  inline static constexpr function_vtable<N> vtable{
+      &evaluate, &eval, &gradient, &copy, &move, &destroy};
+};
+} // namespace detail
+
+// Handle to any expression in at most `N` variables, e.g. to keep formulas of
+// different types in one container or to choose one at runtime. Expressions of
+// up to `Capacity` bytes are stored inline and larger ones on the heap. Every
+// call is dispatched indirectly, so the batched `eval` and `gradient` pay for
+// the dispatch once per range instead of once per point. Evaluation is in
+// `double`.
+template <std::size_t N, std::size_t Capacity = 8 * sizeof(double)>
+class function {
+public:
+  inline static constexpr std::size_t variables = N;
+
+  function() = default;
+
+  template <typename E, std::enable_if_t<detail::is_expression_v<E>>* = nullptr>
+  function(const E& expr) : _vtable(&model<E>::vtable) {
+    static_assert(
+        detail::arity_v<E> <= N, "Expression has more than N variables!"
+    );
+    model<E>::create(&_storage, expr);
+  }
+
+  function(const function& other) : _vtable(other._vtable) {
+    if (_vtable) {
+      _vtable->copy(&other._storage, &_storage);
+    }
+  }
+
+  function(function&& other) noexcept : _vtable(other._vtable) {
+    if (_vtable) {
+      _vtable->move(&other._storage, &_storage);
+      other._vtable = nullptr;
+    }
+  }
+
+  function& operator=(const function& other) {
+    if (this != &other) {
+      function copy(other);
+      *this = std::move(copy);
+    }
+    return *this;
+  }
+
+  function& operator=(function&& other) noexcept {
+    if (this != &other) {
+      reset();
+      if (other._vtable) {
+        other._vtable->move(&other._storage, &_storage);
+      }
+      _vtable       = other._vtable;
+      other._vtable = nullptr;
+    }
+    return *this;
+  }
+
+  ~function() { reset(); }
+
+  explicit operator bool() const noexcept { return _vtable != nullptr; }
+
+  template <typename... Ts>
+  double operator()(Ts... xs) const noexcept {
+    static_assert(sizeof...(Ts) == N, "Expected N arguments!");
+    assert(_vtable);
+    const std::array<double, N> inputs{static_cast<double>(xs)...};
+    return _vtable->evaluate(&_storage, inputs.data());
+  }
+
+  // Evaluates the function for every point of the `N` input ranges and writes
+  // the results to the last range, like `ad::eval`
+  template <typename... Ranges>
+  void eval(Ranges&&... ranges) const {
+    static_assert(sizeof...(Ranges) == N + 1, "Expected N + 1 ranges!");
+    eval_impl(
+        std::forward_as_tuple(ranges...), std::make_index_sequence<N>{}
+    );
+  }
+
+  // Evaluates the function and its gradient for every point of the `N` input
+  // ranges. The values are written to the range `values` and the gradients
+  // row-major to the range `gradients`, which must hold `N` elements per point.
+  template <typename... Ranges>
+  void gradient(Ranges&&... ranges) const {
+    static_assert(sizeof...(Ranges) == N + 2, "Expected N + 2 ranges!");
+    gradient_impl(
+        std::forward_as_tuple(ranges...), std::make_index_sequence<N>{}
+    );
+  }
+
+private:
+  static_assert(Capacity >= sizeof(void*), "Capacity must hold a pointer!");
+
+  template <typename E>
+  using model = detail::function_model<E, N, Capacity>;
+
+  void reset() noexcept {
+    if (_vtable) {
+      _vtable->destroy(&_storage);
+      _vtable = nullptr;
+    }
+  }
+
+  template <typename Args, std::size_t... Is>
+  void eval_impl(Args args, std::index_sequence<Is...>) const {
+    assert(_vtable);
+    auto& out       = std::get<N>(args);
+    const auto size = std::size(out);
+    assert(((std::size(std::get<Is>(args)) >= size) && ...));
+    _vtable->eval(
+        &_storage, {std::data(std::get<Is>(args))...}, size, std::data(out)
+    );
+  }
+
+  template <typename Args, std::size_t... Is>
+  void gradient_impl(Args args, std::index_sequence<Is...>) const {
+    assert(_vtable);
+    auto& values    = std::get<N>(args);
+    auto& gradients = std::get<N + 1>(args);
+    const auto size = std::size(values);
+    assert(((std::size(std::get<Is>(args)) >= size) && ...));
+    assert(std::size(gradients) >= size * N);
+    _vtable->gradient(
+        &_storage,
+        {std::data(std::get<Is>(args))...},
+        size,
+        std::data(values),
+        std::data(gradients)
+    );
+  }
+
+  const detail::function_vtable<N>* _vtable = nullptr;
+  alignas(std::max_align_t) unsigned char _storage[Capacity];
+};
+} // namespace ad
+
+#endif // AUTOMATICDIFFERENTIATION_FUNCTION_HH_1729181467203518837_
@@ -0,0 +1,513 @@
+#ifndef AUTOMATICDIFFERENTIATION_GRAPH_HH_1729173391542006318_
+#define AUTOMATICDIFFERENTIATION_GRAPH_HH_1729173391542006318_
+
+#include "ad.hh"
+
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace ad {
+// Expression graph whose shape is only known at runtime, e.g. a loss with a
+// configurable number of terms. Nodes are stored contiguously in the order in
+// which they are created, which is also a valid evaluation order. The graph
+// can be evaluated and differentiated repeatedly with new inputs without
+// allocating once the buffers have grown to the size of the graph.
+//
+// Nodes refer to the graph they were created in, so the graph must outlive
+// them and must not be moved while they are in use.
+class graph {
+public:
+  enum class operation : std::uint8_t {
+    variable,
+    constant,
+    addition,
+    subtraction,
+    multiplication,
+    division,
+    negation,
+    power,
+    exponential,
+    logarithm,
+    square_root,
+    sinus,
+    cosinus,
+    tangens,
+    sinus_hyperbolicus,
+    cosinus_hyperbolicus,
+    tangens_hyperbolicus,
+    arcus_sinus,
+    arcus_cosinus,
+    arcus_tangens,
+    area_sinus_hyperbolicus,
+    area_cosinus_hyperbolicus,
+    area_tangens_hyperbolicus,
+  };
+
+  class node {
+  public:
+    std::uint32_t index() const noexcept { return _index; }
+    graph& owner() const noexcept { return *_graph; }
+
+  private:
+    friend class graph;
+
+    node(graph* g, std::uint32_t index) noexcept : _graph(g), _index(index) {}
+
+    graph* _graph;
+    std::uint32_t _index;
+  };
+
+  graph() = default;
+  graph(const graph&) = delete;
+  graph& operator=(const graph&) = delete;
+
+  void reserve(std::size_t size) {
+    _nodes.reserve(size);
+    _values.reserve(size);
+    _adjoints.reserve(size);
+  }
+
+  std::size_t size() const noexcept { return _nodes.size(); }
+
+  // Number of inputs needed to evaluate the graph
+  std::size_t variables() const noexcept { return _variables; }
+
+  node variable(std::uint32_t index) {
+    if (index >= _variables) {
+      _variables = index + 1;
+    }
+    return push(operation::variable, static_cast<double>(index));
+  }
+
+  node constant(double value) { return push(operation::constant, value); }
+
+  node unary(operation op, node arg) {
+    assert(arg._graph == this);
+    return push(op, arg._index, arg._index);
+  }
+
+  node binary(operation op, node lhs, node rhs) {
+    assert(lhs._graph == this && rhs._graph == this);
+    return push(op, lhs._index, rhs._index);
+  }
+
+  // Adds the static expression `expr` to the graph. `variable<N>` is mapped to
+  // the `N`th input.
+  template <typename E, std::enable_if_t<detail::is_expression_v<E>>* = nullptr>
+  node insert(const E& expr);
+
+  // Evaluates `output` for the values in the contiguous range `inputs`
+  template <typename Inputs>
+  double evaluate(node output, const Inputs& inputs) {
+    assert(std::size(inputs) >= _variables);
+    return forward(output._index, std::data(inputs));
+  }
+
+  // Evaluates `output` and writes its partial derivatives with respect to all
+  // inputs to the contiguous range `gradient`
+  template <typename Inputs, typename Gradient>
+  double gradient(node output, const Inputs& inputs, Gradient& gradient) {
+    assert(std::size(inputs) >= _variables);
+    assert(std::size(gradient) >= _variables);
+    const double value = forward(output._index, std::data(inputs));
+    backward(output._index, std::data(gradient));
+    return value;
+  }
+
+private:
+  // Leaves refer to themselves as operands. The value of a variable is the
+  // index of its input.
+  struct entry {
+    operation op;
+    std::uint32_t lhs;
+    std::uint32_t rhs;
+    double value;
+  };
+
+  node push(operation op, std::uint32_t lhs, std::uint32_t rhs) {
+    _nodes.push_back(entry{op, lhs, rhs, 0.0});
+    return node{this, static_cast<std::uint32_t>(_nodes.size() - 1)};
+  }
+
+  node push(operation op, double value) {
+    const auto index = static_cast<std::uint32_t>(_nodes.size());
+    _nodes.push_back(entry{op, index, index, value});
+    return node{this, index};
+  }
+
+  static std::size_t input(const entry& e) noexcept {
+    return static_cast<std::size_t>(e.value);
+  }
+
+  double forward(std::uint32_t output, const double* inputs) {
+    using m = math<double>;
+    _values.resize(_nodes.size());
+    for (std::uint32_t i = 0; i <= output; ++i) {
+      const entry& e = _nodes[i];
+      const double l = _values[e.lhs];
+      const double r = _values[e.rhs];
+      double& v      = _values[i];
+      switch (e.op) {
+      case operation::variable: v = inputs[input(e)]; break;
+      case operation::constant: v = e.value; break;
+      case operation::addition: v = l + r; break;
+      case operation::subtraction: v = l - r; break;
+      case operation::multiplication: v = l * r; break;
+      case operation::division: v = l / r; break;
+      case operation::negation: v = -l; break;
+      case operation::power: v = m::pow(l, r); break;
+      case operation::exponential: v = m::exp(l); break;
+      case operation::logarithm: v = m::log(l); break;
+      case operation::square_root: v = m::sqrt(l); break;
+      case operation::sinus: v = m::sin(l); break;
+      case operation::cosinus: v = m::cos(l); break;
+      case operation::tangens: v = m::tan(l); break;
+      case operation::sinus_hyperbolicus: v = m::sinh(l); break;
+      case operation::cosinus_hyperbolicus: v = m::cosh(l); break;
+      case operation::tangens_hyperbolicus: v = m::tanh(l); break;
+      case operation::arcus_sinus: v = m::asin(l); break;
+      case operation::arcus_cosinus: v = m::acos(l); break;
+      case operation::arcus_tangens: v = m::atan(l); break;
+      case operation::area_sinus_hyperbolicus: v = m::asinh(l); break;
+      case operation::area_cosinus_hyperbolicus: v = m::acosh(l); break;
+      case operation::area_tangens_hyperbolicus: v = m::atanh(l); break;
+      }
+    }
+    return _values[output];
+  }
+
+  void backward(std::uint32_t output, double* gradient) {
+    using m = math<double>;
+    for (std::size_t i = 0; i < _variables; ++i) {
+      gradient[i] = 0.0;
+    }
+    _adjoints.assign(output + std::size_t{1}, 0.0);
+    _adjoints[output] = 1.0;
+    for (std::uint32_t i = output + 1; i-- > 0;) {
+      const double a = _adjoints[i];
+      // Nodes the output does not depend on may have infinite partials
+      if (a == 0.0) {
+        continue;
+      }
+      const entry& e = _nodes[i];
+      const double l = _values[e.lhs];
+      const double r = _values[e.rhs];
+      const double v = _values[i];
+      double& dl     = _adjoints[e.lhs];
+      double& dr     = _adjoints[e.rhs];
+      switch (e.op) {
+      case operation::variable: gradient[input(e)] += a; break;
+      case operation::constant: break;
+      case operation::addition:
+        dl += a;
+        dr += a;
+        break;
+      case operation::subtraction:
+        dl += a;
+        dr -= a;
+        break;
+      case operation::multiplication:
+        dl += a * r;
+        dr += a * l;
+        break;
+      case operation::division:
+        dl += a / r;
+        dr -= a * v / r;
+        break;
+      case operation::negation: dl -= a; break;
+      case operation::power:
+        dl += a * r * m::pow(l, r - 1.0);
+        if (_nodes[e.rhs].op != operation::constant) {
+          dr += a * v * m::log(l);
+        }
+        break;
+      case operation::exponential: dl += a * v; break;
+      case operation::logarithm: dl += a / l; break;
+      case operation::square_root: dl += a * 0.5 / v; break;
+      case operation::sinus: dl += a * m::cos(l); break;
+      case operation::cosinus: dl -= a * m::sin(l); break;
+      case operation::tangens: dl += a * (1.0 + v * v); break;
+      case operation::sinus_hyperbolicus: dl += a * m::cosh(l); break;
+      case operation::cosinus_hyperbolicus: dl += a * m::sinh(l); break;
+      case operation::tangens_hyperbolicus: dl += a * (1.0 - v * v); break;
+      case operation::arcus_sinus: dl += a / m::sqrt(1.0 - l * l); break;
+      case operation::arcus_cosinus: dl -= a / m::sqrt(1.0 - l * l); break;
+      case operation::arcus_tangens: dl += a / (1.0 + l * l); break;
+      case operation::area_sinus_hyperbolicus:
+        dl += a / m::sqrt(l * l + 1.0);
+        break;
+      case operation::area_cosinus_hyperbolicus:
+        dl += a / (m::sqrt(l - 1.0) * m::sqrt(l + 1.0));
+        break;
+      case operation::area_tangens_hyperbolicus:
+        dl += a / (1.0 - l * l);
+        break;
+      }
+    }
+  }
+
+  std::vector<entry> _nodes;
+  std::vector<double> _values;
+  std::vector<double> _adjoints;
+  std::size_t _variables = 0;
+};
+
+inline graph::node operator+(graph::node l, graph::node r) {
+  return l.owner().binary(graph::operation::addition, l, r);
+}
+
+inline graph::node operator-(graph::node l, graph::node r) {
+  return l.owner().binary(graph::operation::subtraction, l, r);
+}
+
+inline graph::node operator*(graph::node l, graph::node r) {
+  return l.owner().binary(graph::operation::multiplication, l, r);
+}
+
+inline graph::node operator/(graph::node l, graph::node r) {
+  return l.owner().binary(graph::operation::division, l, r);
+}
+
+inline graph::node operator+(graph::node l, double r) {
+  return l + l.owner().constant(r);
+}
+
+inline graph::node operator-(graph::node l, double r) {
+  return l - l.owner().constant(r);
+}
+
+inline graph::node operator*(graph::node l, double r) {
+  return l * l.owner().constant(r);
+}
+
+inline graph::node operator/(graph::node l, double r) {
+  return l / l.owner().constant(r);
+}
+
+inline graph::node operator+(double l, graph::node r) {
+  return r.owner().constant(l) + r;
+}
+
+inline graph::node operator-(double l, graph::node r) {
+  return r.owner().constant(l) - r;
+}
+
+inline graph::node operator*(double l, graph::node r) {
+  return r.owner().constant(l) * r;
+}
+
+inline graph::node operator/(double l, graph::node r) {
+  return r.owner().constant(l) / r;
+}
+
+inline graph::node operator+(graph::node x) { return x; }
+
+inline graph::node operator-(graph::node x) {
+  return x.owner().unary(graph::operation::negation, x);
+}
+
+inline graph::node pow(graph::node l, graph::node r) {
+  return l.owner().binary(graph::operation::power, l, r);
+}
+
+inline graph::node pow(graph::node l, double r) {
+  return pow(l, l.owner().constant(r));
+}
+
+inline graph::node pow(double l, graph::node r) {
+  return pow(r.owner().constant(l), r);
+}
+
+inline graph::node exp(graph::node x) {
+  return x.owner().unary(graph::operation::exponential, x);
+}
+
+inline graph::node log(graph::node x) {
+  return x.owner().unary(graph::operation::logarithm, x);
+}
+
+inline graph::node sqrt(graph::node x) {
+  return x.owner().unary(graph::operation::square_root, x);
+}
+
+inline graph::node sin(graph::node x) {
+  return x.owner().unary(graph::operation::sinus, x);
+}
+
+inline graph::node cos(graph::node x) {
+  return x.owner().unary(graph::operation::cosinus, x);
+}
+
+inline graph::node tan(graph::node x) {
+  return x.owner().unary(graph::operation::tangens, x);
+}
+
+inline graph::node sinh(graph::node x) {
+  return x.owner().unary(graph::operation::sinus_hyperbolicus, x);
+}
+
+inline graph::node cosh(graph::node x) {
+  return x.owner().unary(graph::operation::cosinus_hyperbolicus, x);
+}
+
+inline graph::node tanh(graph::node x) {
+  return x.owner().unary(graph::operation::tangens_hyperbolicus, x);
+}
+
+inline graph::node asin(graph::node x) {
+  return x.owner().unary(graph::operation::arcus_sinus, x);
+}
+
+inline graph::node acos(graph::node x) {
+  return x.owner().unary(graph::operation::arcus_cosinus, x);
+}
+
+inline graph::node atan(graph::node x) {
+  return x.owner().unary(graph::operation::arcus_tangens, x);
+}
+
+inline graph::node asinh(graph::node x) {
+  return x.owner().unary(graph::operation::area_sinus_hyperbolicus, x);
+}
+
+inline graph::node acosh(graph::node x) {
+  return x.owner().unary(graph::operation::area_cosinus_hyperbolicus, x);
+}
+
+inline graph::node atanh(graph::node x) {
+  return x.owner().unary(graph::operation::area_tangens_hyperbolicus, x);
+}
+
+namespace detail {
+struct graph_impl {
+  template <std::size_t N>
+  static graph::node insert(graph& g, const variable<N>&) {
+    return g.variable(N);
+  }
+
+  template <typename T, std::enable_if_t<is_constant_v<T>>* = nullptr>
+  static graph::node insert(graph& g, const T& x) {
+    return g.constant(x.value());
+  }
+
+  template <typename L, typename R>
+  static graph::node insert(graph& g, const addition<L, R>& x) {
+    return insert(g, x.lhs) + insert(g, x.rhs);
+  }
+
+  template <typename L, typename R>
+  static graph::node insert(graph& g, const subtraction<L, R>& x) {
+    return insert(g, x.lhs) - insert(g, x.rhs);
+  }
+
+  template <typename L, typename R>
+  static graph::node insert(graph& g, const multiplication<L, R>& x) {
+    return insert(g, x.lhs) * insert(g, x.rhs);
+  }
+
+  template <typename L, typename R>
+  static graph::node insert(graph& g, const division<L, R>& x) {
+    return insert(g, x.lhs) / insert(g, x.rhs);
+  }
+
+  template <typename L, typename R>
+  static graph::node insert(graph& g, const power<L, R>& x) {
+    return pow(insert(g, x.lhs), insert(g, x.rhs));
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const negation<T>& x) {
+    return -insert(g, x.arg);
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const exponential<T>& x) {
+    return exp(insert(g, x.arg));
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const logarithm<T>& x) {
+    return log(insert(g, x.arg));
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const square_root<T>& x) {
+    return sqrt(insert(g, x.arg));
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const sinus<T>& x) {
+    return sin(insert(g, x.arg));
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const cosinus<T>& x) {
+    return cos(insert(g, x.arg));
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const tangens<T>& x) {
+    return tan(insert(g, x.arg));
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const sinus_hyperbolicus<T>& x) {
+    return sinh(insert(g, x.arg));
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const cosinus_hyperbolicus<T>& x) {
+    return cosh(insert(g, x.arg));
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const tangens_hyperbolicus<T>& x) {
+    return tanh(insert(g, x.arg));
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const arcus_sinus<T>& x) {
+    return asin(insert(g, x.arg));
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const arcus_cosinus<T>& x) {
+    return acos(insert(g, x.arg));
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const arcus_tangens<T>& x) {
+    return atan(insert(g, x.arg));
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const area_sinus_hyperbolicus<T>& x) {
+    return asinh(insert(g, x.arg));
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const area_cosinus_hyperbolicus<T>& x) {
+    return acosh(insert(g, x.arg));
+  }
+
+  template <typename T>
+  static graph::node insert(graph& g, const area_tangens_hyperbolicus<T>& x) {
+    return atanh(insert(g, x.arg));
+  }
+
+  template <typename T, std::enable_if_t<is_univariate_v<T>>* = nullptr>
+  static graph::node insert(graph& g, const T& x) {
+    return insert(g, x.expand());
+  }
+};
+} // namespace detail
+
+template <typename E, std::enable_if_t<detail::is_expression_v<E>>*>
+graph::node graph::insert(const E& expr) {
+  return detail::graph_impl::insert(*this, expr);
+}
+} // namespace ad
+
+#endif // AUTOMATICDIFFERENTIATION_GRAPH_HH_1729173391542006318_
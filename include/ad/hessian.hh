@@ -0,0 +1,263 @@
+#ifndef AUTOMATICDIFFERENTIATION_HESSIAN_HH_1729178552079166324_
+#define AUTOMATICDIFFERENTIATION_HESSIAN_HH_1729178552079166324_
+
+#include "ad.hh"
+
+#include <array>
+#include <cassert>
+#include <iterator>
+#include <utility>
+
+namespace ad {
+// Second-order forward-mode number carrying a value, its gradient and its
+// Hessian with respect to `N` variables. Only the upper triangle of the
+// symmetric Hessian is stored, packed row by row.
+template <typename S, std::size_t N>
+struct second_order_dual {
+  inline static constexpr std::size_t packed_size = N * (N + 1) / 2;
+
+  S value{};
+  std::array<S, N> gradient{};
+  std::array<S, packed_size> hessian{};
+
+  constexpr second_order_dual() = default;
+
+  constexpr second_order_dual(S x) noexcept : value(x) {}
+
+  // Index of the element `(i, j)` with `i <= j` in `hessian`
+  static constexpr std::size_t index(std::size_t i, std::size_t j) noexcept {
+    return i * N - i * (i - 1) / 2 + (j - i);
+  }
+
+  // Returns the element `(i, j)` of the Hessian for any `i` and `j`
+  constexpr S second(std::size_t i, std::size_t j) const noexcept {
+    return i <= j ? hessian[index(i, j)] : hessian[index(j, i)];
+  }
+
+  template <std::size_t I>
+  static constexpr second_order_dual variable(S x) noexcept {
+    static_assert(I < N);
+    second_order_dual result{x};
+    result.gradient[I] = S(1);
+    return result;
+  }
+
+  // Returns `f(*this)` given `f(value)`, `f'(value)` and `f''(value)`
+  constexpr second_order_dual chain(S f, S df, S d2f) const noexcept {
+    second_order_dual result{f};
+    for (std::size_t i = 0; i < N; ++i) {
+      result.gradient[i] = df * gradient[i];
+      for (std::size_t j = i; j < N; ++j) {
+        result.hessian[index(i, j)] = df * hessian[index(i, j)]
+                                    + d2f * gradient[i] * gradient[j];
+      }
+    }
+    return result;
+  }
+
+  friend constexpr second_order_dual
+  operator+(const second_order_dual& x) noexcept {
+    return x;
+  }
+
+  friend constexpr second_order_dual
+  operator-(const second_order_dual& x) noexcept {
+    return x.chain(-x.value, S(-1), S(0));
+  }
+
+  friend constexpr second_order_dual
+  operator+(const second_order_dual& l, const second_order_dual& r) noexcept {
+    second_order_dual result{l.value + r.value};
+    for (std::size_t i = 0; i < N; ++i) {
+      result.gradient[i] = l.gradient[i] + r.gradient[i];
+    }
+    for (std::size_t k = 0; k < packed_size; ++k) {
+      result.hessian[k] = l.hessian[k] + r.hessian[k];
+    }
+    return result;
+  }
+
+  friend constexpr second_order_dual
+  operator-(const second_order_dual& l, const second_order_dual& r) noexcept {
+    second_order_dual result{l.value - r.value};
+    for (std::size_t i = 0; i < N; ++i) {
+      result.gradient[i] = l.gradient[i] - r.gradient[i];
+    }
+    for (std::size_t k = 0; k < packed_size; ++k) {
+      result.hessian[k] = l.hessian[k] - r.hessian[k];
+    }
+    return result;
+  }
+
+  friend constexpr second_order_dual
+  operator*(const second_order_dual& l, const second_order_dual& r) noexcept {
+    second_order_dual result{l.value * r.value};
+    for (std::size_t i = 0; i < N; ++i) {
+      result.gradient[i] = l.gradient[i] * r.value + l.value * r.gradient[i];
+      for (std::size_t j = i; j < N; ++j) {
+        const std::size_t k = index(i, j);
+        result.hessian[k]   = l.hessian[k] * r.value + l.value * r.hessian[k]
+                          + l.gradient[i] * r.gradient[j]
+                          + l.gradient[j] * r.gradient[i];
+      }
+    }
+    return result;
+  }
+
+  friend constexpr second_order_dual
+  operator/(const second_order_dual& l, const second_order_dual& r) noexcept {
+    const S inverse = S(1) / r.value;
+    const S square  = inverse * inverse;
+    return l * r.chain(inverse, -square, S(2) * square * inverse);
+  }
+};
+
+template <typename S, std::size_t N>
+struct math<second_order_dual<S, N>> {
+  using T = second_order_dual<S, N>;
+
+  static constexpr T exp(const T& x) noexcept {
+    const S e = math<S>::exp(x.value);
+    return x.chain(e, e, e);
+  }
+
+  static constexpr T log(const T& x) noexcept {
+    const S inverse = S(1) / x.value;
+    return x.chain(math<S>::log(x.value), inverse, -inverse * inverse);
+  }
+
+  static constexpr T sqrt(const T& x) noexcept {
+    const S r  = math<S>::sqrt(x.value);
+    const S d1 = S(0.5) / r;
+    return x.chain(r, d1, -S(0.5) * d1 / x.value);
+  }
+
+  static constexpr T sin(const T& x) noexcept {
+    const S s = math<S>::sin(x.value);
+    return x.chain(s, math<S>::cos(x.value), -s);
+  }
+
+  static constexpr T cos(const T& x) noexcept {
+    const S c = math<S>::cos(x.value);
+    return x.chain(c, -math<S>::sin(x.value), -c);
+  }
+
+  static constexpr T tan(const T& x) noexcept {
+    const S t  = math<S>::tan(x.value);
+    const S d1 = S(1) + t * t;
+    return x.chain(t, d1, S(2) * t * d1);
+  }
+
+  static constexpr T sinh(const T& x) noexcept {
+    const S s = math<S>::sinh(x.value);
+    return x.chain(s, math<S>::cosh(x.value), s);
+  }
+
+  static constexpr T cosh(const T& x) noexcept {
+    const S c = math<S>::cosh(x.value);
+    return x.chain(c, math<S>::sinh(x.value), c);
+  }
+
+  static constexpr T tanh(const T& x) noexcept {
+    const S t  = math<S>::tanh(x.value);
+    const S d1 = S(1) - t * t;
+    return x.chain(t, d1, S(-2) * t * d1);
+  }
+
+  static constexpr T asin(const T& x) noexcept {
+    const S d = S(1) / math<S>::sqrt(S(1) - x.value * x.value);
+    return x.chain(math<S>::asin(x.value), d, x.value * d * d * d);
+  }
+
+  static constexpr T acos(const T& x) noexcept {
+    const S d = S(1) / math<S>::sqrt(S(1) - x.value * x.value);
+    return x.chain(math<S>::acos(x.value), -d, -x.value * d * d * d);
+  }
+
+  static constexpr T atan(const T& x) noexcept {
+    const S d = S(1) / (S(1) + x.value * x.value);
+    return x.chain(math<S>::atan(x.value), d, S(-2) * x.value * d * d);
+  }
+
+  static constexpr T asinh(const T& x) noexcept {
+    const S d = S(1) / math<S>::sqrt(x.value * x.value + S(1));
+    return x.chain(math<S>::asinh(x.value), d, -x.value * d * d * d);
+  }
+
+  static constexpr T acosh(const T& x) noexcept {
+    const S d = S(1) / (math<S>::sqrt(x.value - S(1))
+                        * math<S>::sqrt(x.value + S(1)));
+    return x.chain(math<S>::acosh(x.value), d, -x.value * d * d * d);
+  }
+
+  static constexpr T atanh(const T& x) noexcept {
+    const S d = S(1) / (S(1) - x.value * x.value);
+    return x.chain(math<S>::atanh(x.value), d, S(2) * x.value * d * d);
+  }
+
+  static constexpr T pow(const T& x, const T& y) noexcept {
+    if (is_constant(y)) {
+      const S c  = y.value;
+      const S d1 = c * math<S>::pow(x.value, c - S(1));
+      const S d2 = c * (c - S(1)) * math<S>::pow(x.value, c - S(2));
+      return x.chain(math<S>::pow(x.value, c), d1, d2);
+    }
+    return exp(y * log(x));
+  }
+
+private:
+  static constexpr bool is_constant(const T& x) noexcept {
+    for (const S& g : x.gradient) {
+      if (g != S(0)) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+namespace detail {
+template <typename S, typename E, typename... Ts, std::size_t... Is>
+constexpr auto value_gradient_and_hessian_impl(
+    const E& expr, std::index_sequence<Is...>, Ts... xs
+) {
+  using D = second_order_dual<S, sizeof...(Ts)>;
+  return expr(D::template variable<Is>(static_cast<S>(xs))...);
+}
+} // namespace detail
+
+// Evaluates `expr`, its gradient and the upper triangle of its Hessian at `xs`
+// in a single pass
+template <
+    typename E,
+    typename... Ts,
+    std::enable_if_t<detail::is_expression_v<E>>* = nullptr>
+constexpr auto value_gradient_and_hessian(const E& expr, Ts... xs) noexcept {
+  return detail::value_gradient_and_hessian_impl<detail::scalar_t<Ts...>>(
+      expr, std::index_sequence_for<Ts...>{}, xs...
+  );
+}
+
+// Writes the dense symmetric Hessian of `expr` at `xs` to the contiguous range
+// `out` with at least `sizeof...(xs)^2` elements and returns the value of
+// `expr`. Only the upper triangle is computed and mirrored.
+template <
+    typename E,
+    typename Range,
+    typename... Ts,
+    std::enable_if_t<detail::is_expression_v<E>>* = nullptr>
+constexpr auto hessian(const E& expr, Range&& out, Ts... xs) noexcept {
+  constexpr std::size_t n = sizeof...(Ts);
+  assert(std::size(out) >= n * n);
+  const auto result = value_gradient_and_hessian(expr, xs...);
+  auto* const dst   = std::data(out);
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = i; j < n; ++j) {
+      dst[i * n + j] = dst[j * n + i] = result.hessian[result.index(i, j)];
+    }
+  }
+  return result.value;
+}
+} // namespace ad
+
+#endif // AUTOMATICDIFFERENTIATION_HESSIAN_HH_1729178552079166324_
@@ -0,0 +1,91 @@
+#ifndef AUTOMATICDIFFERENTIATION_JACOBIAN_HH_1729176104226573509_
+#define AUTOMATICDIFFERENTIATION_JACOBIAN_HH_1729176104226573509_
+
+#include "ad.hh"
+#include "cse.hh"
+#include "dual.hh"
+
+#include <array>
+#include <cassert>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+namespace ad {
+enum class layout { row_major, column_major };
+
+namespace detail {
+// Vector-valued function whose components are expressions over the same
+// variables
+template <typename... Es>
+struct vector_expression {
+  std::tuple<Es...> components;
+
+  inline static constexpr std::size_t size = sizeof...(Es);
+
+  using subexpressions = subexpressions_t<Es...>;
+
+  // Evaluates all components. Static subexpressions are shared between them
+  // and evaluated only once.
+  template <
+      typename... Ts,
+      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>
+  constexpr auto operator()(Ts... xs) const noexcept {
+    using S           = scalar_t<Ts...>;
+    using impl        = cse_impl<subexpressions>;
+    const auto values = impl::template fill<S>(xs...);
+    return std::apply(
+        [&](const auto&... fs) {
+          return std::array<S, size>{impl::evaluate(fs, values, xs...)...};
+        },
+        components
+    );
+  }
+};
+} // namespace detail
+
+template <
+    typename... Es,
+    std::enable_if_t<(detail::is_expression_v<Es> && ...)>* = nullptr>
+constexpr auto make_vector(Es... fs) noexcept {
+  return detail::vector_expression<Es...>{{fs...}};
+}
+
+// Evaluates all components of `fs` and their partial derivatives at `xs` in a
+// single pass. The Jacobian is written to the contiguous range `out`, which
+// must hold at least `fs.size * sizeof...(xs)` elements, and the values of the
+// components are returned.
+template <
+    layout Layout = layout::row_major,
+    typename... Es,
+    typename Range,
+    typename... Ts>
+constexpr auto jacobian(
+    const detail::vector_expression<Es...>& fs, Range&& out, Ts... xs
+) noexcept {
+  using S                 = detail::scalar_t<Ts...>;
+  constexpr std::size_t m = sizeof...(Es);
+  constexpr std::size_t n = sizeof...(Ts);
+  assert(std::size(out) >= m * n);
+
+  const auto results = detail::value_and_gradient_impl<S>(
+      fs, std::index_sequence_for<Ts...>{}, xs...
+  );
+  std::array<S, m> values{};
+  auto* const dst = std::data(out);
+  for (std::size_t i = 0; i < m; ++i) {
+    values[i] = results[i].value;
+    for (std::size_t j = 0; j < n; ++j) {
+      if constexpr (Layout == layout::row_major) {
+        dst[i * n + j] = results[i].gradient[j];
+      }
+      else {
+        dst[j * m + i] = results[i].gradient[j];
+      }
+    }
+  }
+  return values;
+}
+} // namespace ad
+
+#endif // AUTOMATICDIFFERENTIATION_JACOBIAN_HH_1729176104226573509_
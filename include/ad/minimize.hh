@@ -0,0 +1,511 @@
+#ifndef AUTOMATICDIFFERENTIATION_MINIMIZE_HH_1729190125564790433_
+#define AUTOMATICDIFFERENTIATION_MINIMIZE_HH_1729190125564790433_
+
+#include "ad.hh"
+#include "hessian.hh"
+#include "reverse.hh"
+#include "solve.hh"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace ad {
+struct minimizer_options {
+  // Iterations stop once the largest component of the gradient is at most
+  // `tolerance`
+  double tolerance           = 1e-10;
+  std::size_t max_iterations = 200;
+  // Maximum number of evaluations of one line search of `minimize_lbfgs`
+  std::size_t max_line_search = 20;
+  // Initial trust region radius of `minimize_newton`
+  double radius = 1;
+};
+
+struct minimizer_result {
+  bool converged         = false;
+  std::size_t iterations = 0;
+  // Number of evaluations of the function with its derivatives
+  std::size_t evaluations = 0;
+  // Value of the function at the minimum
+  double value = 0;
+};
+
+// Passed to the observer of a minimizer after every iteration, e.g. to log or
+// time the progress
+struct minimizer_progress {
+  std::size_t iteration   = 0;
+  std::size_t evaluations = 0;
+  double value            = 0;
+  // Largest component of the gradient
+  double gradient_norm = 0;
+};
+
+// Memory used by `minimize_lbfgs` in `N` variables, which keeps the last `M`
+// steps and gradient differences in a ring buffer
+template <std::size_t N, std::size_t M = 8, typename S = double>
+struct lbfgs_workspace {
+  std::array<std::array<S, N>, M> steps{};
+  std::array<std::array<S, N>, M> differences{};
+  std::array<S, M> rhos{};
+  std::array<S, M> alphas{};
+  std::array<S, N> gradient{};
+  std::array<S, N> direction{};
+  std::array<S, N> trial{};
+  std::array<S, N> trial_gradient{};
+};
+
+// Memory used by `minimize_newton` in `N` variables
+template <std::size_t N, typename S = double>
+struct newton_workspace {
+  // Value, gradient and packed Hessian at the current and the trial point
+  second_order_dual<S, N> point{};
+  second_order_dual<S, N> trial_point{};
+  // `H + lambda I`, factored in place
+  std::array<S, N * N> matrix{};
+  std::array<S, N> step{};
+  std::array<S, N> trial{};
+  std::array<S, N> solution{};
+};
+
+namespace detail {
+struct ignore_progress {
+  constexpr void operator()(const minimizer_progress&) const noexcept {}
+};
+
+template <typename S, std::size_t N>
+constexpr S dot(const std::array<S, N>& x, const std::array<S, N>& y) noexcept {
+  S result = S(0);
+  for (std::size_t i = 0; i < N; ++i) {
+    result += x[i] * y[i];
+  }
+  return result;
+}
+
+template <typename E, typename S, std::size_t N, std::size_t... Is>
+constexpr auto
+gradient_at(const E& f, const std::array<S, N>& x, std::index_sequence<Is...>) {
+  return reverse_gradient<S>(f, x[Is]...);
+}
+
+template <typename E, typename S, std::size_t N, std::size_t... Is>
+constexpr auto second_order_at(
+    const E& f, const std::array<S, N>& x, std::index_sequence<Is...>
+) {
+  return value_gradient_and_hessian(f, x[Is]...);
+}
+} // namespace detail
+
+// Minimizes `f` with the limited-memory BFGS method, starting from and
+// overwriting `x`. The inverse Hessian is approximated from the last `M`
+// steps, and every step length satisfies the weak Wolfe conditions, so the
+// approximation stays positive definite. Gradients are computed in reverse
+// mode. `observer(const minimizer_progress&)` is called after every iteration.
+template <
+    typename E,
+    typename S,
+    std::size_t N,
+    std::size_t M,
+    typename Observer = detail::ignore_progress,
+    std::enable_if_t<detail::is_expression_v<E>>* = nullptr>
+minimizer_result minimize_lbfgs(
+    const E& f,
+    std::array<S, N>& x,
+    lbfgs_workspace<N, M, S>& workspace,
+    const minimizer_options& options = {},
+    Observer&& observer = {}
+) {
+  static_assert(M > 0, "Expected at least one stored step!");
+  static_assert(detail::arity_v<E> <= N, "Too few variables!");
+  constexpr auto is = std::make_index_sequence<N>{};
+  constexpr S c1    = S(1e-4);
+  constexpr S c2    = S(0.9);
+  const S tolerance = static_cast<S>(options.tolerance);
+  const S infinity  = std::numeric_limits<S>::infinity();
+  minimizer_result result;
+  auto& ws = workspace;
+
+  const auto evaluate = [&](const std::array<S, N>& at, std::array<S, N>& g) {
+    ++result.evaluations;
+    const auto d = detail::gradient_at(f, at, is);
+    g            = d.gradient;
+    return d.value;
+  };
+
+  S value           = evaluate(x, ws.gradient);
+  std::size_t count = 0;
+  std::size_t head  = 0;
+  for (;; ++result.iterations) {
+    result.value = value;
+    const S norm = detail::max_norm(ws.gradient);
+    if (result.iterations > 0) {
+      observer(minimizer_progress{
+          result.iterations, result.evaluations, value, norm});
+    }
+    if (norm <= tolerance) {
+      result.converged = true;
+      return result;
+    }
+    if (result.iterations == options.max_iterations || !(norm < infinity)) {
+      return result;
+    }
+
+    // Two-loop recursion from the newest to the oldest pair and back
+    auto& d = ws.direction;
+    for (std::size_t i = 0; i < N; ++i) {
+      d[i] = -ws.gradient[i];
+    }
+    for (std::size_t k = 0; k < count; ++k) {
+      const std::size_t j = (head + M - 1 - k) % M;
+      ws.alphas[j]        = ws.rhos[j] * detail::dot(ws.steps[j], d);
+      for (std::size_t i = 0; i < N; ++i) {
+        d[i] -= ws.alphas[j] * ws.differences[j][i];
+      }
+    }
+    S alpha = S(1);
+    if (count > 0) {
+      const std::size_t j = (head + M - 1) % M;
+      const S yy          = detail::dot(ws.differences[j], ws.differences[j]);
+      const S gamma       = S(1) / (ws.rhos[j] * yy);
+      for (std::size_t i = 0; i < N; ++i) {
+        d[i] *= gamma;
+      }
+    }
+    else {
+      alpha = std::min(S(1), S(1) / norm);
+    }
+    for (std::size_t k = count; k-- > 0;) {
+      const std::size_t j = (head + M - 1 - k) % M;
+      const S beta        = ws.rhos[j] * detail::dot(ws.differences[j], d);
+      for (std::size_t i = 0; i < N; ++i) {
+        d[i] += (ws.alphas[j] - beta) * ws.steps[j][i];
+      }
+    }
+    S slope = detail::dot(ws.gradient, d);
+    if (!(slope < S(0))) {
+      // Restart from steepest descent if the approximation broke down
+      count = 0;
+      for (std::size_t i = 0; i < N; ++i) {
+        d[i] = -ws.gradient[i];
+      }
+      slope = -detail::dot(ws.gradient, ws.gradient);
+      alpha = std::min(S(1), S(1) / norm);
+    }
+
+    // Bracket a step length satisfying the weak Wolfe conditions and shrink
+    // the bracket by safeguarded quadratic interpolation
+    S lo          = S(0);
+    S lo_value    = value;
+    S lo_slope    = slope;
+    S hi          = infinity;
+    S hi_value    = infinity;
+    S trial_value = value;
+    bool accepted = false;
+    for (std::size_t search = 0; search < options.max_line_search; ++search) {
+      for (std::size_t i = 0; i < N; ++i) {
+        ws.trial[i] = x[i] + alpha * d[i];
+      }
+      trial_value = evaluate(ws.trial, ws.trial_gradient);
+      if (!(trial_value <= value + c1 * alpha * slope)) {
+        hi       = alpha;
+        hi_value = trial_value;
+      }
+      else {
+        const S trial_slope = detail::dot(ws.trial_gradient, d);
+        if (trial_slope >= c2 * slope) {
+          accepted = true;
+          break;
+        }
+        lo       = alpha;
+        lo_value = trial_value;
+        lo_slope = trial_slope;
+      }
+      if (hi == infinity) {
+        alpha *= 2;
+        continue;
+      }
+      const S width = hi - lo;
+      alpha         = lo + width / 2;
+      if (hi_value < infinity) {
+        const S curvature = hi_value - lo_value - lo_slope * width;
+        if (curvature > S(0)) {
+          alpha = std::clamp(
+              lo - lo_slope * width * width / (2 * curvature),
+              lo + width / 10,
+              hi - width / 10
+          );
+        }
+      }
+    }
+    if (!accepted) {
+      return result;
+    }
+
+    auto& s = ws.steps[head];
+    auto& y = ws.differences[head];
+    for (std::size_t i = 0; i < N; ++i) {
+      s[i] = ws.trial[i] - x[i];
+      y[i] = ws.trial_gradient[i] - ws.gradient[i];
+    }
+    const S sy = detail::dot(s, y);
+    if (sy > S(0)) {
+      ws.rhos[head] = S(1) / sy;
+      head          = (head + 1) % M;
+      count         = std::min(count + 1, M);
+    }
+    x           = ws.trial;
+    ws.gradient = ws.trial_gradient;
+    value       = trial_value;
+  }
+}
+
+template <
+    std::size_t M = 8,
+    typename E,
+    typename S,
+    std::size_t N,
+    typename Observer = detail::ignore_progress,
+    std::enable_if_t<detail::is_expression_v<E>>* = nullptr>
+minimizer_result minimize_lbfgs(
+    const E& f,
+    std::array<S, N>& x,
+    const minimizer_options& options = {},
+    Observer&& observer = {}
+) {
+  lbfgs_workspace<N, M, S> workspace;
+  return minimize_lbfgs(
+      f, x, workspace, options, std::forward<Observer>(observer)
+  );
+}
+
+// Minimizes `f` with Newton's method in a trust region, starting from and
+// overwriting `x`. Value, gradient and exact Hessian come from one
+// second-order forward pass per iteration. Each step minimizes the quadratic
+// model within the trust region by shifting the Hessian until it is positive
+// definite and the step fits, so saddle points and indefinite regions are
+// left along directions of negative curvature. `observer(const
+// minimizer_progress&)` is called after every iteration.
+template <
+    typename E,
+    typename S,
+    std::size_t N,
+    typename Observer = detail::ignore_progress,
+    std::enable_if_t<detail::is_expression_v<E>>* = nullptr>
+minimizer_result minimize_newton(
+    const E& f,
+    std::array<S, N>& x,
+    newton_workspace<N, S>& workspace,
+    const minimizer_options& options = {},
+    Observer&& observer = {}
+) {
+  static_assert(detail::arity_v<E> <= N, "Too few variables!");
+  constexpr auto is = std::make_index_sequence<N>{};
+  constexpr S eta   = S(1e-4);
+  const S tolerance = static_cast<S>(options.tolerance);
+  minimizer_result result;
+  auto& ws = workspace;
+  using std::abs;
+  using std::sqrt;
+
+  // Factors `H + lambda I` into `matrix` and solves for the step
+  const auto shifted_step = [&](S lambda) {
+    const auto& point = ws.point;
+    for (std::size_t i = 0; i < N; ++i) {
+      for (std::size_t j = 0; j <= i; ++j) {
+        ws.matrix[i * N + j] = point.second(i, j);
+      }
+      ws.matrix[i * N + i] += lambda;
+    }
+    if (!detail::cholesky_factor<S, N>(ws.matrix)) {
+      return false;
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+      ws.step[i] = -point.gradient[i];
+    }
+    detail::cholesky_solve<S, N>(ws.matrix, ws.step);
+    return true;
+  };
+
+  // Finds `lambda >= 0` with `|step| <= radius`, and close to it if `lambda`
+  // is positive, by Newton's method on `1 / |step(lambda)|`. `lambda` stays
+  // above the largest shift known to leave `H + lambda I` indefinite.
+  const auto constrained_step = [&](S radius) {
+    // Shift after which `H + lambda I` is diagonally dominant
+    const auto gershgorin = [&] {
+      S result = S(0);
+      for (std::size_t i = 0; i < N; ++i) {
+        S off = S(0);
+        for (std::size_t j = 0; j < N; ++j) {
+          off += i == j ? S(0) : abs(ws.point.second(i, j));
+        }
+        result = std::max(result, off - ws.point.second(i, i));
+      }
+      return result;
+    };
+    S lambda     = S(0);
+    S indefinite = S(-1);
+    S definite   = std::numeric_limits<S>::infinity();
+    S length     = S(0);
+    bool solved  = false;
+    for (std::size_t k = 0; k < 30; ++k) {
+      solved = shifted_step(lambda);
+      if (!solved) {
+        if (definite < std::numeric_limits<S>::infinity()) {
+          indefinite = lambda;
+          lambda     = (lambda + definite) / 2;
+        }
+        else {
+          const S lower = indefinite < S(0) ? gershgorin() : S(0);
+          indefinite    = lambda;
+          lambda = std::max({2 * lambda, lower, radius * S(1e-8)});
+        }
+        continue;
+      }
+      definite = lambda;
+      length   = sqrt(detail::dot(ws.step, ws.step));
+      if (length <= radius && (lambda == S(0) || length >= S(0.9) * radius)) {
+        return;
+      }
+      if (length <= radius * S(1.1) && length >= radius * S(0.9)) {
+        break;
+      }
+      // `solution` holds `L^-1 step`
+      for (std::size_t i = 0; i < N; ++i) {
+        S s = ws.step[i];
+        for (std::size_t j = 0; j < i; ++j) {
+          s -= ws.matrix[i * N + j] * ws.solution[j];
+        }
+        ws.solution[i] = s / ws.matrix[i * N + i];
+      }
+      const S q = detail::dot(ws.solution, ws.solution);
+      S next    = lambda + length * length / q * (length - radius) / radius;
+      if (next <= indefinite) {
+        next = (indefinite + lambda) / 2;
+      }
+      lambda = std::max(S(0), next);
+    }
+    if (!solved) {
+      if (!(definite < std::numeric_limits<S>::infinity())) {
+        ws.step = {};
+        return;
+      }
+      shifted_step(definite);
+      length = sqrt(detail::dot(ws.step, ws.step));
+    }
+    if (length > radius) {
+      for (std::size_t i = 0; i < N; ++i) {
+        ws.step[i] *= radius / length;
+      }
+    }
+    else if (length < radius && definite > S(0)) {
+      // The gradient is nearly orthogonal to the directions of most negative
+      // curvature, so `lambda` cannot reach the boundary. Two steps of inverse
+      // iteration from the row of the smallest pivot approximate such a
+      // direction `z`, and `step + tau z` is extended to the boundary.
+      std::size_t smallest = 0;
+      for (std::size_t i = 1; i < N; ++i) {
+        if (ws.matrix[i * N + i] < ws.matrix[smallest * N + smallest]) {
+          smallest = i;
+        }
+      }
+      auto& z     = ws.solution;
+      z           = {};
+      z[smallest] = S(1);
+      for (std::size_t k = 0; k < 2; ++k) {
+        detail::cholesky_solve<S, N>(ws.matrix, z);
+        const S norm = sqrt(detail::dot(z, z));
+        for (std::size_t i = 0; i < N; ++i) {
+          z[i] /= norm;
+        }
+      }
+      // Both roots change the model by about as much, so take the shorter one
+      using std::copysign;
+      const S pz  = detail::dot(ws.step, z);
+      const S tau = copysign(
+          sqrt(pz * pz + radius * radius - length * length), pz
+      ) - pz;
+      for (std::size_t i = 0; i < N; ++i) {
+        ws.step[i] += tau * z[i];
+      }
+    }
+  };
+
+  ++result.evaluations;
+  ws.point = detail::second_order_at(f, x, is);
+  S radius = static_cast<S>(options.radius);
+  for (;; ++result.iterations) {
+    const auto& point = ws.point;
+    result.value      = point.value;
+    const S norm      = detail::max_norm(point.gradient);
+    if (result.iterations > 0) {
+      observer(minimizer_progress{
+          result.iterations, result.evaluations, point.value, norm});
+    }
+    if (norm <= tolerance) {
+      result.converged = true;
+      return result;
+    }
+    if (result.iterations == options.max_iterations
+        || !(norm < std::numeric_limits<S>::infinity())) {
+      return result;
+    }
+
+    constrained_step(radius);
+    // Reduction of the quadratic model `g^T p + p^T H p / 2`
+    S predicted = S(0);
+    for (std::size_t i = 0; i < N; ++i) {
+      S hp = S(0);
+      for (std::size_t j = 0; j < N; ++j) {
+        hp += point.second(i, j) * ws.step[j];
+      }
+      predicted -= ws.step[i] * (point.gradient[i] + hp / 2);
+    }
+    const S length = sqrt(detail::dot(ws.step, ws.step));
+    if (!(predicted > S(0))) {
+      return result;
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+      ws.trial[i] = x[i] + ws.step[i];
+    }
+    ++result.evaluations;
+    ws.trial_point = detail::second_order_at(f, ws.trial, is);
+    const S rho    = (point.value - ws.trial_point.value) / predicted;
+    if (!(rho >= S(0.25))) {
+      radius = length / 4;
+    }
+    else if (rho > S(0.75) && length >= S(0.9) * radius) {
+      radius *= 2;
+    }
+    if (rho > eta) {
+      x        = ws.trial;
+      ws.point = ws.trial_point;
+    }
+    else if (radius <= std::numeric_limits<S>::epsilon()
+                           * std::max(S(1), detail::max_norm(x))) {
+      return result;
+    }
+  }
+}
+
+template <
+    typename E,
+    typename S,
+    std::size_t N,
+    typename Observer = detail::ignore_progress,
+    std::enable_if_t<detail::is_expression_v<E>>* = nullptr>
+minimizer_result minimize_newton(
+    const E& f,
+    std::array<S, N>& x,
+    const minimizer_options& options = {},
+    Observer&& observer = {}
+) {
+  newton_workspace<N, S> workspace;
+  return minimize_newton(
+      f, x, workspace, options, std::forward<Observer>(observer)
+  );
+}
+} // namespace ad
+
+#endif // AUTOMATICDIFFERENTIATION_MINIMIZE_HH_1729190125564790433_
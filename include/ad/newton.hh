@@ -0,0 +1,249 @@
+#ifndef AUTOMATICDIFFERENTIATION_NEWTON_HH_1729183024915536271_
+#define AUTOMATICDIFFERENTIATION_NEWTON_HH_1729183024915536271_
+
+#include "ad.hh"
+#include "batch.hh"
+#include "dual.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ad {
+struct newton_options {
+  // A lane has converged once `|f(x)|` is at most `tolerance` or its Newton
+  // step is at most `tolerance * max(1, |x|)`
+  double tolerance           = 1e-12;
+  std::size_t max_iterations = 50;
+  // Number of threads the lanes are split across. Zero picks
+  // `std::thread::hardware_concurrency()`. Every thread gets at least
+  // `lanes_per_thread` lanes.
+  std::size_t threads          = 0;
+  std::size_t lanes_per_thread = std::size_t(1) << 14;
+};
+
+struct newton_result {
+  // Number of lanes that converged
+  std::size_t converged = 0;
+  // Largest number of iterations over all lanes
+  std::size_t iterations = 0;
+
+  newton_result& operator+=(const newton_result& other) noexcept {
+    converged += other.converged;
+    iterations = std::max(iterations, other.iterations);
+    return *this;
+  }
+};
+
+namespace detail {
+// Runs Newton's method on the lanes `[begin, end)` one block of `batch_size`
+// lanes at a time. The value and derivative of every active lane are computed
+// in one batched pass with dual numbers, and converged lanes are compacted out
+// of the block so that later iterations only evaluate the remaining ones.
+template <bool Parametric, typename E, typename S>
+newton_result newton_lanes(
+    const E& f,
+    const S* starts,
+    const S* parameters,
+    S* roots,
+    std::size_t begin,
+    std::size_t end,
+    const newton_options& options
+) {
+  using D = dual<S, 1>;
+  newton_result result;
+  S xs[batch_size];
+  D points[batch_size];
+  D ps[batch_size];
+  D values[batch_size];
+  std::size_t lanes[batch_size];
+  for (std::size_t offset = begin; offset < end; offset += batch_size) {
+    std::size_t active = std::min(batch_size, end - offset);
+    for (std::size_t i = 0; i < active; ++i) {
+      lanes[i] = offset + i;
+      xs[i]    = starts[offset + i];
+      if constexpr (Parametric) {
+        ps[i] = D(parameters[offset + i]);
+      }
+    }
+    std::size_t iteration = 0;
+    for (; active > 0 && iteration < options.max_iterations; ++iteration) {
+      for (std::size_t i = 0; i < active; ++i) {
+        points[i] = D::template variable<0>(xs[i]);
+      }
+      if constexpr (Parametric) {
+        batch_impl::eval(f, batch_inputs<D, 2>{points, ps}, active, values);
+      }
+      else {
+        batch_impl::eval(f, batch_inputs<D, 1>{points}, active, values);
+      }
+      std::size_t remaining = 0;
+      for (std::size_t i = 0; i < active; ++i) {
+        using std::abs;
+        const S tolerance   = static_cast<S>(options.tolerance);
+        const S derivative  = values[i].gradient[0];
+        const bool residual = abs(values[i].value) <= tolerance;
+        if (derivative == S(0)
+            || !(abs(derivative) <= std::numeric_limits<S>::max())) {
+          if (residual) {
+            roots[lanes[i]] = xs[i];
+            ++result.converged;
+          }
+          else {
+            roots[lanes[i]] = std::numeric_limits<S>::quiet_NaN();
+          }
+          continue;
+        }
+        const S step  = values[i].value / derivative;
+        const S x     = xs[i] - step;
+        const S scale = std::max(S(1), abs(x));
+        if (!(abs(x) <= std::numeric_limits<S>::max())) {
+          roots[lanes[i]] = std::numeric_limits<S>::quiet_NaN();
+        }
+        else if (residual || abs(step) <= tolerance * scale) {
+          roots[lanes[i]] = x;
+          ++result.converged;
+        }
+        else {
+          lanes[remaining] = lanes[i];
+          xs[remaining]    = x;
+          if constexpr (Parametric) {
+            ps[remaining] = ps[i];
+          }
+          ++remaining;
+        }
+      }
+      active = remaining;
+    }
+    for (std::size_t i = 0; i < active; ++i) {
+      roots[lanes[i]] = std::numeric_limits<S>::quiet_NaN();
+    }
+    result.iterations = std::max(result.iterations, iteration);
+  }
+  return result;
+}
+
+template <bool Parametric, typename E, typename S>
+newton_result newton(
+    const E& f,
+    const S* starts,
+    const S* parameters,
+    S* roots,
+    std::size_t size,
+    const newton_options& options
+) {
+  std::size_t threads = options.threads;
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  const std::size_t per_thread = std::max<std::size_t>(
+      options.lanes_per_thread, (size + threads - 1) / threads
+  );
+  threads = std::max<std::size_t>(1, (size + per_thread - 1) / per_thread);
+  if (threads == 1) {
+    return newton_lanes<Parametric>(
+        f, starts, parameters, roots, 0, size, options
+    );
+  }
+
+  std::vector<newton_result> results(threads);
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  try {
+    for (std::size_t t = 1; t < threads; ++t) {
+      const std::size_t begin = t * per_thread;
+      const std::size_t end   = std::min(size, begin + per_thread);
+      workers.emplace_back([&, t, begin, end] {
+        results[t] = newton_lanes<Parametric>(
+            f, starts, parameters, roots, begin, end, options
+        );
+      });
+    }
+  }
+  catch (...) {
+    // Destroying a joinable thread terminates the program
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+    throw;
+  }
+  results[0] = newton_lanes<Parametric>(
+      f, starts, parameters, roots, 0, per_thread, options
+  );
+  newton_result result;
+  for (std::size_t t = 0; t < threads; ++t) {
+    if (t > 0) {
+      workers[t - 1].join();
+    }
+    result += results[t];
+  }
+  return result;
+}
+} // namespace detail
+
+// Finds a root of `f(x)` from every starting point in the contiguous range
+// `starts` with Newton's method and writes it to `roots`. Lanes that do not
+// converge within `options.max_iterations` iterations or whose iteration breaks
+// down, e.g. at a vanishing derivative off a root, get a NaN root.
+template <
+    typename E,
+    typename Starts,
+    typename Roots,
+    std::enable_if_t<detail::is_expression_v<E>>* = nullptr>
+newton_result find_roots(
+    const E& f,
+    const Starts& starts,
+    Roots&& roots,
+    const newton_options& options = {}
+) {
+  static_assert(
+      detail::arity_v<E> <= 1, "Use the overload with parameters for ad::_1!"
+  );
+  assert(std::size(roots) <= std::size(starts));
+  return detail::newton<false>(
+      f,
+      std::data(starts),
+      decltype(std::data(roots))(nullptr),
+      std::data(roots),
+      std::size(roots),
+      options
+  );
+}
+
+// Finds a root in `x` of `f(x, p)` for every parameter `p` in the contiguous
+// range `parameters`, starting from the corresponding element of `starts`
+template <
+    typename E,
+    typename Starts,
+    typename Parameters,
+    typename Roots,
+    std::enable_if_t<
+        detail::is_expression_v<E>
+        && !std::is_same_v<std::decay_t<Roots>, newton_options>>* = nullptr>
+newton_result find_roots(
+    const E& f,
+    const Starts& starts,
+    const Parameters& parameters,
+    Roots&& roots,
+    const newton_options& options = {}
+) {
+  static_assert(detail::arity_v<E> <= 2, "Too many variables!");
+  assert(std::size(roots) <= std::size(starts));
+  assert(std::size(roots) <= std::size(parameters));
+  return detail::newton<true>(
+      f,
+      std::data(starts),
+      std::data(parameters),
+      std::data(roots),
+      std::size(roots),
+      options
+  );
+}
+} // namespace ad
+
+#endif // AUTOMATICDIFFERENTIATION_NEWTON_HH_1729183024915536271_
@@ -62,6 +62,17 @@ struct print_impl {
     os << x.value();
   }
 
+  // Rationals are printed exactly
+  template <long N, long D>
+  static void print(std::ostream& os, const static_constant<N, D>&) {
+    if constexpr (D == 1) {
+      os << N;
+    }
+    else {
+      os << N << " / " << D;
+    }
+  }
+
   template <std::size_t N>
   static void print(std::ostream& os, const variable<N>&) {
     os << format_variable<N>::rep;
@@ -133,6 +144,16 @@ private:
     return 3;
   }
 
+  template <long N, long D>
+  static constexpr int precedence(const static_constant<N, D>&) {
+    return D == 1 ? 4 : 2;
+  }
+
+  template <typename T, std::enable_if_t<is_univariate_v<T>>* = nullptr>
+  static constexpr int precedence(const T& x) {
+    return precedence(x.expand());
+  }
+
   static constexpr int precedence(...) { return 4; }
 
 public:
@@ -236,9 +257,15 @@ public:
     print_function(os, "sqrt", x);
   }
 
+  // Polynomials with collected coefficients are printed as sums of powers
+  template <typename T, std::enable_if_t<is_univariate_v<T>>* = nullptr>
+  static void print(std::ostream& os, const T& x) {
+    print(os, x.expand());
+  }
+
   template <typename T>
   static void print(std::ostream& os, const negation<T>& x) {
-    if constexpr (detail::is_binary_operator_v<std::decay_t<decltype(x.arg)>>) {
+    if constexpr (detail::is_binary_operator_v<T> || is_univariate_v<T>) {
       os << "-(";
       print(os, x.arg);
       os << ')';
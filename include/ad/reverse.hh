@@ -0,0 +1,265 @@
+#ifndef AUTOMATICDIFFERENTIATION_REVERSE_HH_1729170932608745142_
+#define AUTOMATICDIFFERENTIATION_REVERSE_HH_1729170932608745142_
+
+#include "ad.hh"
+#include "dual.hh"
+
+#include <array>
+#include <utility>
+
+namespace ad {
+struct reverse_mode_t {
+  explicit reverse_mode_t() = default;
+};
+
+inline constexpr reverse_mode_t reverse_mode{};
+
+namespace detail {
+// Number of nodes in the tree of `E`, i.e. the number of values stored in the
+// forward sweep
+template <typename E>
+inline constexpr std::size_t tape_size_v = 1;
+
+template <template <typename> typename E, typename T>
+inline constexpr std::size_t tape_size_v<E<T>> = 1 + tape_size_v<T>;
+
+template <template <typename, typename> typename E, typename L, typename R>
+inline constexpr std::size_t tape_size_v<E<L, R>> =
+    1 + tape_size_v<L> + tape_size_v<R>;
+
+template <typename E>
+inline constexpr bool has_variable_v = is_variable_v<E>;
+
+template <template <typename> typename E, typename T>
+inline constexpr bool has_variable_v<E<T>> = has_variable_v<T>;
+
+template <template <typename, typename> typename E, typename L, typename R>
+inline constexpr bool has_variable_v<E<L, R>> =
+    has_variable_v<L> || has_variable_v<R>;
+
+// The tape stores the value of every node in post-order starting at `I`, so the
+// value of a node of type `E` is found at `I + tape_size_v<E> - 1`.
+struct reverse_impl {
+  template <
+      std::size_t I,
+      typename E,
+      typename S,
+      std::size_t K,
+      typename... Ts>
+  static constexpr S
+  forward(const E& x, std::array<S, K>& tape, Ts... xs) noexcept {
+    constexpr std::size_t self = I + tape_size_v<E> - 1;
+    if constexpr (is_unary_v<E>) {
+      tape[self] = E::apply(forward<I>(x.arg, tape, xs...));
+    }
+    else if constexpr (is_binary_v<E>) {
+      constexpr std::size_t rhs = I + tape_size_v<operand_t<E, 0>>;
+      tape[self] = E::apply(
+          forward<I>(x.lhs, tape, xs...), forward<rhs>(x.rhs, tape, xs...)
+      );
+    }
+    else {
+      tape[self] = x(xs...);
+    }
+    return tape[self];
+  }
+
+  template <std::size_t I, typename E, typename S, std::size_t K, std::size_t N>
+  static constexpr void backward(
+      const E& x,
+      const std::array<S, K>& tape,
+      S adjoint,
+      std::array<S, N>& gradient
+  ) noexcept {
+    if constexpr (is_variable_v<E>) {
+      gradient[E::value] += adjoint;
+    }
+    else if constexpr (!has_variable_v<E>) {
+      // Nothing to propagate
+    }
+    else if constexpr (is_unary_v<E>) {
+      constexpr std::size_t self = I + tape_size_v<E> - 1;
+      constexpr std::size_t arg  = I + tape_size_v<operand_t<E, 0>> - 1;
+      backward<I>(
+          x.arg,
+          tape,
+          adjoint * partial(x, tape[arg], tape[self]),
+          gradient
+      );
+    }
+    else {
+      constexpr std::size_t self = I + tape_size_v<E> - 1;
+      constexpr std::size_t rhs  = I + tape_size_v<operand_t<E, 0>>;
+      const auto [dl, dr] =
+          partials(x, tape[rhs - 1], tape[self - 1], tape[self]);
+      backward<I>(x.lhs, tape, adjoint * dl, gradient);
+      backward<rhs>(x.rhs, tape, adjoint * dr, gradient);
+    }
+  }
+
+private:
+  // Derivatives of unary nodes with respect to their argument given the value
+  // `x` of the argument and the value `fx` of the node
+  template <typename T, typename S>
+  static constexpr S partial(const negation<T>&, S, S) noexcept {
+    return S(-1);
+  }
+
+  template <typename T, typename S>
+  static constexpr S partial(const exponential<T>&, S, S fx) noexcept {
+    return fx;
+  }
+
+  template <typename T, typename S>
+  static constexpr S partial(const logarithm<T>&, S x, S) noexcept {
+    return S(1) / x;
+  }
+
+  template <typename T, typename S>
+  static constexpr S partial(const square_root<T>&, S, S fx) noexcept {
+    return S(0.5) / fx;
+  }
+
+  template <typename T, typename S>
+  static constexpr S partial(const sinus<T>&, S x, S) noexcept {
+    return math<S>::cos(x);
+  }
+
+  template <typename T, typename S>
+  static constexpr S partial(const cosinus<T>&, S x, S) noexcept {
+    return -math<S>::sin(x);
+  }
+
+  template <typename T, typename S>
+  static constexpr S partial(const tangens<T>&, S, S fx) noexcept {
+    return S(1) + fx * fx;
+  }
+
+  template <typename T, typename S>
+  static constexpr S partial(const sinus_hyperbolicus<T>&, S x, S) noexcept {
+    return math<S>::cosh(x);
+  }
+
+  template <typename T, typename S>
+  static constexpr S partial(const cosinus_hyperbolicus<T>&, S x, S) noexcept {
+    return math<S>::sinh(x);
+  }
+
+  template <typename T, typename S>
+  static constexpr S partial(const tangens_hyperbolicus<T>&, S, S fx) noexcept {
+    return S(1) - fx * fx;
+  }
+
+  template <typename T, typename S>
+  static constexpr S partial(const arcus_sinus<T>&, S x, S) noexcept {
+    return S(1) / math<S>::sqrt(S(1) - x * x);
+  }
+
+  template <typename T, typename S>
+  static constexpr S partial(const arcus_cosinus<T>&, S x, S) noexcept {
+    return S(-1) / math<S>::sqrt(S(1) - x * x);
+  }
+
+  template <typename T, typename S>
+  static constexpr S partial(const arcus_tangens<T>&, S x, S) noexcept {
+    return S(1) / (S(1) + x * x);
+  }
+
+  template <typename T, typename S>
+  static constexpr S
+  partial(const area_sinus_hyperbolicus<T>&, S x, S) noexcept {
+    return S(1) / math<S>::sqrt(x * x + S(1));
+  }
+
+  template <typename T, typename S>
+  static constexpr S
+  partial(const area_cosinus_hyperbolicus<T>&, S x, S) noexcept {
+    return S(1) / (math<S>::sqrt(x - S(1)) * math<S>::sqrt(x + S(1)));
+  }
+
+  template <typename T, typename S>
+  static constexpr S
+  partial(const area_tangens_hyperbolicus<T>&, S x, S) noexcept {
+    return S(1) / (S(1) - x * x);
+  }
+
+  template <
+      typename E,
+      typename S,
+      std::enable_if_t<is_univariate_v<E>>* = nullptr>
+  static constexpr S partial(const E&, S x, S) noexcept {
+    return E::coefficients::derivative_t::evaluate(x);
+  }
+
+  // Derivatives of binary nodes with respect to both operands given the values
+  // of the operands and of the node
+  template <typename L, typename R, typename S>
+  static constexpr std::pair<S, S>
+  partials(const addition<L, R>&, S, S, S) noexcept {
+    return {S(1), S(1)};
+  }
+
+  template <typename L, typename R, typename S>
+  static constexpr std::pair<S, S>
+  partials(const subtraction<L, R>&, S, S, S) noexcept {
+    return {S(1), S(-1)};
+  }
+
+  template <typename L, typename R, typename S>
+  static constexpr std::pair<S, S>
+  partials(const multiplication<L, R>&, S l, S r, S) noexcept {
+    return {r, l};
+  }
+
+  template <typename L, typename R, typename S>
+  static constexpr std::pair<S, S>
+  partials(const division<L, R>&, S, S r, S v) noexcept {
+    const S inverse = S(1) / r;
+    return {inverse, -v * inverse};
+  }
+
+  template <typename L, typename R, typename S>
+  static constexpr std::pair<S, S>
+  partials(const power<L, R>&, S l, S r, S v) noexcept {
+    const S dl = [&] {
+      if constexpr (has_static_pow_v<R>) {
+        return r * static_pow<R::numerator - R::denominator, R::denominator>(l);
+      }
+      else {
+        return r * math<S>::pow(l, r - S(1));
+      }
+    }();
+    if constexpr (has_variable_v<R>) {
+      return {dl, v * math<S>::log(l)};
+    }
+    else {
+      return {dl, S(0)};
+    }
+  }
+};
+
+template <typename S, typename E, typename... Ts>
+constexpr auto reverse_gradient(const E& expr, Ts... xs) noexcept {
+  std::array<S, tape_size_v<E>> tape{};
+  dual<S, sizeof...(Ts)> result{
+      reverse_impl::forward<0>(expr, tape, static_cast<S>(xs)...)};
+  reverse_impl::backward<0>(expr, tape, S(1), result.gradient);
+  return result;
+}
+} // namespace detail
+
+// Computes the same as `value_and_gradient(expr, xs...)` in reverse mode: One
+// forward sweep stores the value of every node in a fixed-size array on the
+// stack and one backward sweep propagates the adjoints to the variables. The
+// cost is independent of the number of variables.
+template <
+    typename E,
+    typename... Ts,
+    std::enable_if_t<detail::is_expression_v<E>>* = nullptr>
+constexpr auto
+value_and_gradient(reverse_mode_t, const E& expr, Ts... xs) noexcept {
+  return detail::reverse_gradient<detail::scalar_t<Ts...>>(expr, xs...);
+}
+} // namespace ad
+
+#endif // AUTOMATICDIFFERENTIATION_REVERSE_HH_1729170932608745142_
@@ -0,0 +1,364 @@
+#ifndef AUTOMATICDIFFERENTIATION_SOLVE_HH_1729185871022463591_
+#define AUTOMATICDIFFERENTIATION_SOLVE_HH_1729185871022463591_
+
+#include "ad.hh"
+#include "jacobian.hh"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace ad {
+struct solver_options {
+  // Iterations stop once the largest residual, the largest component of the
+  // gradient of the squared residuals or the largest step relative to
+  // `max(1, |x|)` is at most `tolerance`
+  double tolerance           = 1e-12;
+  std::size_t max_iterations = 100;
+  // Initial Levenberg-Marquardt damping relative to the largest diagonal
+  // element of `J^T J`. Zero takes undamped Gauss-Newton steps.
+  double damping = 1e-3;
+};
+
+struct solver_result {
+  bool converged         = false;
+  std::size_t iterations = 0;
+  // Half the sum of the squared residuals at the solution
+  double cost = 0;
+};
+
+// Memory used by the solvers for `M` residuals in `N` variables. Everything is
+// sized at compile time, so a solver allocates nothing, and a workspace can be
+// reused across calls to keep large systems off the stack.
+template <std::size_t M, std::size_t N, typename S = double>
+struct solver_workspace {
+  std::array<S, M> residuals{};
+  std::array<S, M> trial_residuals{};
+  // Row-major Jacobian of the residuals, which Newton's method eliminates in
+  // place
+  std::array<S, M * N> jacobian{};
+  // `J^T J + mu I`, factored in place by least squares
+  std::array<S, N * N> matrix{};
+  std::array<S, N> gradient{};
+  std::array<S, N> step{};
+  std::array<S, N> trial{};
+};
+
+namespace detail {
+template <typename S, std::size_t N>
+constexpr S max_norm(const std::array<S, N>& x) noexcept {
+  S result = S(0);
+  for (std::size_t i = 0; i < N; ++i) {
+    using std::abs;
+    result = std::max(result, abs(x[i]));
+  }
+  return result;
+}
+
+template <typename S, std::size_t N>
+constexpr S squared_norm(const std::array<S, N>& x) noexcept {
+  S result = S(0);
+  for (std::size_t i = 0; i < N; ++i) {
+    result += x[i] * x[i];
+  }
+  return result;
+}
+
+// Solves `a x = b` in place of `b` by Gaussian elimination with partial
+// pivoting, overwriting the row-major `a`. Returns false if `a` is singular.
+template <typename S, std::size_t N>
+constexpr bool
+linear_solve(std::array<S, N * N>& a, std::array<S, N>& b) noexcept {
+  for (std::size_t k = 0; k < N; ++k) {
+    using std::abs;
+    std::size_t p = k;
+    S largest     = abs(a[k * N + k]);
+    for (std::size_t i = k + 1; i < N; ++i) {
+      if (abs(a[i * N + k]) > largest) {
+        p       = i;
+        largest = abs(a[i * N + k]);
+      }
+    }
+    if (largest == S(0)) {
+      return false;
+    }
+    if (p != k) {
+      for (std::size_t j = k; j < N; ++j) {
+        std::swap(a[k * N + j], a[p * N + j]);
+      }
+      std::swap(b[k], b[p]);
+    }
+    const S inverse = S(1) / a[k * N + k];
+    for (std::size_t i = k + 1; i < N; ++i) {
+      const S l = a[i * N + k] * inverse;
+      for (std::size_t j = k + 1; j < N; ++j) {
+        a[i * N + j] -= l * a[k * N + j];
+      }
+      b[i] -= l * b[k];
+    }
+  }
+  for (std::size_t k = N; k-- > 0;) {
+    for (std::size_t j = k + 1; j < N; ++j) {
+      b[k] -= a[k * N + j] * b[j];
+    }
+    b[k] /= a[k * N + k];
+  }
+  return true;
+}
+
+// Factors the symmetric positive definite `a` in place into `L L^T`, using
+// only its lower triangle. Returns false if `a` is not positive definite.
+template <typename S, std::size_t N>
+constexpr bool cholesky_factor(std::array<S, N * N>& a) noexcept {
+  for (std::size_t j = 0; j < N; ++j) {
+    S d = a[j * N + j];
+    for (std::size_t k = 0; k < j; ++k) {
+      d -= a[j * N + k] * a[j * N + k];
+    }
+    if (!(d > S(0))) {
+      return false;
+    }
+    using std::sqrt;
+    d            = sqrt(d);
+    a[j * N + j] = d;
+    for (std::size_t i = j + 1; i < N; ++i) {
+      S s = a[i * N + j];
+      for (std::size_t k = 0; k < j; ++k) {
+        s -= a[i * N + k] * a[j * N + k];
+      }
+      a[i * N + j] = s / d;
+    }
+  }
+  return true;
+}
+
+// Solves `L L^T x = b` in place of `b`
+template <typename S, std::size_t N>
+constexpr void
+cholesky_solve(const std::array<S, N * N>& l, std::array<S, N>& b) noexcept {
+  for (std::size_t i = 0; i < N; ++i) {
+    for (std::size_t k = 0; k < i; ++k) {
+      b[i] -= l[i * N + k] * b[k];
+    }
+    b[i] /= l[i * N + i];
+  }
+  for (std::size_t i = N; i-- > 0;) {
+    for (std::size_t k = i + 1; k < N; ++k) {
+      b[i] -= l[k * N + i] * b[k];
+    }
+    b[i] /= l[i * N + i];
+  }
+}
+
+template <typename... Es, typename S, std::size_t N, std::size_t... Is>
+constexpr auto residuals_at(
+    const vector_expression<Es...>& fs,
+    const std::array<S, N>& x,
+    std::index_sequence<Is...>
+) noexcept {
+  return fs(x[Is]...);
+}
+
+// Returns the residuals at `x` and writes their Jacobian to `jacobian`
+template <
+    typename... Es,
+    typename S,
+    std::size_t N,
+    std::size_t K,
+    std::size_t... Is>
+constexpr auto jacobian_at(
+    const vector_expression<Es...>& fs,
+    const std::array<S, N>& x,
+    std::array<S, K>& jacobian,
+    std::index_sequence<Is...>
+) noexcept {
+  return ad::jacobian(fs, jacobian, x[Is]...);
+}
+
+template <typename... Es>
+inline constexpr std::size_t vector_arity_v = std::max({arity_v<Es>...});
+} // namespace detail
+
+// Solves the square system `fs(x) = 0` with Newton's method, starting from and
+// overwriting `x`. The Jacobian is evaluated in one pass with the residuals,
+// and every step is solved for by Gaussian elimination in place in `workspace`.
+template <typename... Es, typename S, std::size_t N>
+constexpr solver_result solve(
+    const detail::vector_expression<Es...>& fs,
+    std::array<S, N>& x,
+    solver_workspace<sizeof...(Es), N, S>& workspace,
+    const solver_options& options = {}
+) noexcept {
+  static_assert(
+      sizeof...(Es) == N, "Expected as many residuals as variables!"
+  );
+  static_assert(detail::vector_arity_v<Es...> <= N, "Too few variables!");
+  constexpr auto is = std::make_index_sequence<N>{};
+  const S tolerance = static_cast<S>(options.tolerance);
+  solver_result result;
+  auto& ws = workspace;
+  for (; result.iterations < options.max_iterations; ++result.iterations) {
+    ws.residuals = detail::jacobian_at(fs, x, ws.jacobian, is);
+    result.cost  = 0.5 * detail::squared_norm(ws.residuals);
+    if (detail::max_norm(ws.residuals) <= tolerance) {
+      result.converged = true;
+      return result;
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+      ws.step[i] = -ws.residuals[i];
+    }
+    if (!detail::linear_solve<S, N>(ws.jacobian, ws.step)) {
+      return result;
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+      x[i] += ws.step[i];
+    }
+    const S scale = std::max(S(1), detail::max_norm(x));
+    if (detail::max_norm(ws.step) <= tolerance * scale) {
+      ws.residuals     = detail::residuals_at(fs, x, is);
+      result.cost      = 0.5 * detail::squared_norm(ws.residuals);
+      result.converged = true;
+      ++result.iterations;
+      return result;
+    }
+  }
+  return result;
+}
+
+template <typename... Es, typename S, std::size_t N>
+constexpr solver_result solve(
+    const detail::vector_expression<Es...>& fs,
+    std::array<S, N>& x,
+    const solver_options& options = {}
+) noexcept {
+  solver_workspace<sizeof...(Es), N, S> workspace;
+  return solve(fs, x, workspace, options);
+}
+
+// Minimizes half the sum of the squared residuals `fs(x)` with the
+// Levenberg-Marquardt method, starting from and overwriting `x`. Every step
+// solves `(J^T J + mu I) h = -J^T f` by a Cholesky factorization in place in
+// `workspace`. The damping `mu` shrinks after successful steps and grows after
+// failed ones, so the method moves between gradient descent and Gauss-Newton.
+template <typename... Es, typename S, std::size_t N>
+constexpr solver_result least_squares(
+    const detail::vector_expression<Es...>& fs,
+    std::array<S, N>& x,
+    solver_workspace<sizeof...(Es), N, S>& workspace,
+    const solver_options& options = {}
+) noexcept {
+  constexpr std::size_t m = sizeof...(Es);
+  static_assert(m >= N, "Expected at least as many residuals as variables!");
+  static_assert(detail::vector_arity_v<Es...> <= N, "Too few variables!");
+  constexpr auto is = std::make_index_sequence<N>{};
+  const S tolerance = static_cast<S>(options.tolerance);
+  solver_result result;
+  auto& ws = workspace;
+
+  // Evaluates the Jacobian at `x` and the normal equations into `gradient`
+  // and the lower triangle of `matrix` without damping
+  const auto linearize = [&] {
+    ws.residuals = detail::jacobian_at(fs, x, ws.jacobian, is);
+    result.cost  = 0.5 * detail::squared_norm(ws.residuals);
+    for (std::size_t i = 0; i < N; ++i) {
+      S g = S(0);
+      for (std::size_t k = 0; k < m; ++k) {
+        g += ws.jacobian[k * N + i] * ws.residuals[k];
+      }
+      ws.gradient[i] = g;
+    }
+  };
+  const auto normal_matrix = [&](S mu) {
+    for (std::size_t i = 0; i < N; ++i) {
+      for (std::size_t j = 0; j <= i; ++j) {
+        S a = S(0);
+        for (std::size_t k = 0; k < m; ++k) {
+          a += ws.jacobian[k * N + i] * ws.jacobian[k * N + j];
+        }
+        ws.matrix[i * N + j] = a;
+      }
+      ws.matrix[i * N + i] += mu;
+    }
+  };
+
+  linearize();
+  S mu = S(0);
+  if (options.damping > 0) {
+    normal_matrix(S(0));
+    S diagonal = S(0);
+    for (std::size_t i = 0; i < N; ++i) {
+      diagonal = std::max(diagonal, ws.matrix[i * N + i]);
+    }
+    mu = static_cast<S>(options.damping) * diagonal;
+  }
+  S growth = S(2);
+  for (; result.iterations < options.max_iterations; ++result.iterations) {
+    if (detail::max_norm(ws.gradient) <= tolerance
+        || detail::max_norm(ws.residuals) <= tolerance) {
+      result.converged = true;
+      return result;
+    }
+    normal_matrix(mu);
+    if (!detail::cholesky_factor<S, N>(ws.matrix)) {
+      if (mu == S(0)) {
+        return result;
+      }
+      mu *= growth;
+      growth *= 2;
+      continue;
+    }
+    for (std::size_t i = 0; i < N; ++i) {
+      ws.step[i] = -ws.gradient[i];
+    }
+    detail::cholesky_solve<S, N>(ws.matrix, ws.step);
+    const S scale = std::max(S(1), detail::max_norm(x));
+    if (detail::max_norm(ws.step) <= tolerance * scale) {
+      result.converged = true;
+      return result;
+    }
+
+    for (std::size_t i = 0; i < N; ++i) {
+      ws.trial[i] = x[i] + ws.step[i];
+    }
+    if (mu == S(0)) {
+      // Gauss-Newton takes every step
+      x = ws.trial;
+      linearize();
+      continue;
+    }
+    ws.trial_residuals = detail::residuals_at(fs, ws.trial, is);
+    const S cost       = 0.5 * detail::squared_norm(ws.trial_residuals);
+    // Ratio of the actual to the predicted reduction of the cost
+    S predicted = S(0);
+    for (std::size_t i = 0; i < N; ++i) {
+      predicted += ws.step[i] * (mu * ws.step[i] - ws.gradient[i]);
+    }
+    const S rho = (result.cost - cost) / (0.5 * predicted);
+    if (rho > S(0)) {
+      x = ws.trial;
+      linearize();
+      const S t = 2 * rho - 1;
+      mu *= std::max(S(1) / 3, 1 - t * t * t);
+      growth = S(2);
+    }
+    else {
+      mu *= growth;
+      growth *= 2;
+    }
+  }
+  return result;
+}
+
+template <typename... Es, typename S, std::size_t N>
+constexpr solver_result least_squares(
+    const detail::vector_expression<Es...>& fs,
+    std::array<S, N>& x,
+    const solver_options& options = {}
+) noexcept {
+  solver_workspace<sizeof...(Es), N, S> workspace;
+  return least_squares(fs, x, workspace, options);
+}
+} // namespace ad
+
+#endif // AUTOMATICDIFFERENTIATION_SOLVE_HH_1729185871022463591_
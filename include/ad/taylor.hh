@@ -0,0 +1,284 @@
+#ifndef AUTOMATICDIFFERENTIATION_TAYLOR_HH_1729180311404417386_
+#define AUTOMATICDIFFERENTIATION_TAYLOR_HH_1729180311404417386_
+
+#include "ad.hh"
+
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace ad {
+// Truncated power series `c[0] + c[1] t + ... + c[K] t^K` of a univariate
+// function around a point. The coefficients are the normalized derivatives
+// `f^(k) / k!`.
+template <typename S, std::size_t K>
+struct taylor {
+  std::array<S, K + 1> c{};
+
+  constexpr taylor() = default;
+
+  constexpr taylor(S x) noexcept : c{x} {}
+
+  // Returns the series of the identity at `x`
+  static constexpr taylor variable(S x) noexcept {
+    taylor result{x};
+    if constexpr (K > 0) {
+      result.c[1] = S(1);
+    }
+    return result;
+  }
+
+  // Returns the `k`th derivative
+  constexpr S derivative(std::size_t k) const noexcept {
+    S factorial = S(1);
+    for (std::size_t i = 2; i <= k; ++i) {
+      factorial *= static_cast<S>(i);
+    }
+    return c[k] * factorial;
+  }
+
+  friend constexpr taylor operator+(const taylor& x) noexcept { return x; }
+
+  friend constexpr taylor operator-(const taylor& x) noexcept {
+    taylor result;
+    for (std::size_t k = 0; k <= K; ++k) {
+      result.c[k] = -x.c[k];
+    }
+    return result;
+  }
+
+  friend constexpr taylor operator+(const taylor& l, const taylor& r) noexcept {
+    taylor result;
+    for (std::size_t k = 0; k <= K; ++k) {
+      result.c[k] = l.c[k] + r.c[k];
+    }
+    return result;
+  }
+
+  friend constexpr taylor operator-(const taylor& l, const taylor& r) noexcept {
+    taylor result;
+    for (std::size_t k = 0; k <= K; ++k) {
+      result.c[k] = l.c[k] - r.c[k];
+    }
+    return result;
+  }
+
+  friend constexpr taylor operator*(const taylor& l, const taylor& r) noexcept {
+    taylor result;
+    for (std::size_t k = 0; k <= K; ++k) {
+      for (std::size_t j = 0; j <= k; ++j) {
+        result.c[k] += l.c[j] * r.c[k - j];
+      }
+    }
+    return result;
+  }
+
+  friend constexpr taylor operator/(const taylor& l, const taylor& r) noexcept {
+    const S inverse = S(1) / r.c[0];
+    taylor result;
+    for (std::size_t k = 0; k <= K; ++k) {
+      S sum = l.c[k];
+      for (std::size_t j = 0; j < k; ++j) {
+        sum -= result.c[j] * r.c[k - j];
+      }
+      result.c[k] = sum * inverse;
+    }
+    return result;
+  }
+};
+
+// The series of all functions follow from `f' = g(u) u'`, which yields the
+// coefficients `f[k] = 1/k sum_{j=1}^k j u[j] g[k-j]`.
+template <typename S, std::size_t K>
+struct math<taylor<S, K>> {
+  using T = taylor<S, K>;
+
+  static constexpr T exp(const T& x) noexcept {
+    T result{math<S>::exp(x.c[0])};
+    for (std::size_t k = 1; k <= K; ++k) {
+      result.c[k] = term(k, x, result);
+    }
+    return result;
+  }
+
+  static constexpr T log(const T& x) noexcept {
+    return integrate(math<S>::log(x.c[0]), x, S(1) / x);
+  }
+
+  static constexpr T sqrt(const T& x) noexcept {
+    T result{math<S>::sqrt(x.c[0])};
+    const S inverse = S(0.5) / result.c[0];
+    for (std::size_t k = 1; k <= K; ++k) {
+      S sum = x.c[k];
+      for (std::size_t j = 1; j < k; ++j) {
+        sum -= result.c[j] * result.c[k - j];
+      }
+      result.c[k] = sum * inverse;
+    }
+    return result;
+  }
+
+  static constexpr T sin(const T& x) noexcept {
+    return sin_cos(x, S(-1)).first;
+  }
+
+  static constexpr T cos(const T& x) noexcept {
+    return sin_cos(x, S(-1)).second;
+  }
+
+  static constexpr T tan(const T& x) noexcept { return tan_tanh(x, S(1)); }
+
+  static constexpr T sinh(const T& x) noexcept {
+    return sin_cos(x, S(1)).first;
+  }
+
+  static constexpr T cosh(const T& x) noexcept {
+    return sin_cos(x, S(1)).second;
+  }
+
+  static constexpr T tanh(const T& x) noexcept { return tan_tanh(x, S(-1)); }
+
+  static constexpr T asin(const T& x) noexcept {
+    return integrate(math<S>::asin(x.c[0]), x, S(1) / sqrt(S(1) - x * x));
+  }
+
+  static constexpr T acos(const T& x) noexcept {
+    return integrate(math<S>::acos(x.c[0]), x, S(-1) / sqrt(S(1) - x * x));
+  }
+
+  static constexpr T atan(const T& x) noexcept {
+    return integrate(math<S>::atan(x.c[0]), x, S(1) / (S(1) + x * x));
+  }
+
+  static constexpr T asinh(const T& x) noexcept {
+    return integrate(math<S>::asinh(x.c[0]), x, S(1) / sqrt(x * x + S(1)));
+  }
+
+  static constexpr T acosh(const T& x) noexcept {
+    return integrate(
+        math<S>::acosh(x.c[0]), x, S(1) / (sqrt(x - S(1)) * sqrt(x + S(1)))
+    );
+  }
+
+  static constexpr T atanh(const T& x) noexcept {
+    return integrate(math<S>::atanh(x.c[0]), x, S(1) / (S(1) - x * x));
+  }
+
+  static constexpr T pow(const T& x, const T& y) noexcept {
+    for (std::size_t k = 1; k <= K; ++k) {
+      if (y.c[k] != S(0)) {
+        return exp(y * log(x));
+      }
+    }
+    const S a = y.c[0];
+    if (x.c[0] == S(0)) {
+      // The recurrence divides by `x.c[0]`, so fall back to repeated
+      // multiplication for natural exponents
+      using std::floor;
+      if (a >= S(0) && a == floor(a)) {
+        T result{S(1)};
+        for (S i = S(0); i < a; i += S(1)) {
+          result = result * x;
+        }
+        return result;
+      }
+    }
+    // `p = x^a` satisfies `x p' = a p x'`
+    T result{math<S>::pow(x.c[0], a)};
+    const S inverse = S(1) / x.c[0];
+    for (std::size_t k = 1; k <= K; ++k) {
+      S sum = S(0);
+      for (std::size_t j = 1; j <= k; ++j) {
+        const S factor = (a + S(1)) * static_cast<S>(j) - static_cast<S>(k);
+        sum += factor * x.c[j] * result.c[k - j];
+      }
+      result.c[k] = sum * inverse / static_cast<S>(k);
+    }
+    return result;
+  }
+
+private:
+  static constexpr S term(std::size_t k, const T& u, const T& g) noexcept {
+    S sum = S(0);
+    for (std::size_t j = 1; j <= k; ++j) {
+      sum += static_cast<S>(j) * u.c[j] * g.c[k - j];
+    }
+    return sum / static_cast<S>(k);
+  }
+
+  // Returns `f` with `f(0) = f0` and `f' = g u'`
+  static constexpr T integrate(S f0, const T& u, const T& g) noexcept {
+    T result{f0};
+    for (std::size_t k = 1; k <= K; ++k) {
+      result.c[k] = term(k, u, g);
+    }
+    return result;
+  }
+
+  // Returns `(s, c)` with `s' = c u'` and `c' = sign s u'`, i.e. `sin` and
+  // `cos` for `sign == -1` and `sinh` and `cosh` for `sign == 1`
+  static constexpr std::pair<T, T> sin_cos(const T& u, S sign) noexcept {
+    std::pair<T, T> result;
+    auto& [s, c] = result;
+    if (sign < S(0)) {
+      s.c[0] = math<S>::sin(u.c[0]);
+      c.c[0] = math<S>::cos(u.c[0]);
+    }
+    else {
+      s.c[0] = math<S>::sinh(u.c[0]);
+      c.c[0] = math<S>::cosh(u.c[0]);
+    }
+    for (std::size_t k = 1; k <= K; ++k) {
+      s.c[k] = term(k, u, c);
+      c.c[k] = sign * term(k, u, s);
+    }
+    return result;
+  }
+
+  // Returns `t` with `t' = (1 + sign t^2) u'`, i.e. `tan` for `sign == 1` and
+  // `tanh` for `sign == -1`
+  static constexpr T tan_tanh(const T& u, S sign) noexcept {
+    T t{sign > S(0) ? math<S>::tan(u.c[0]) : math<S>::tanh(u.c[0])};
+    T w{S(1) + sign * t.c[0] * t.c[0]};
+    for (std::size_t k = 1; k <= K; ++k) {
+      t.c[k] = term(k, u, w);
+      S square = S(0);
+      for (std::size_t j = 0; j <= k; ++j) {
+        square += t.c[j] * t.c[k - j];
+      }
+      w.c[k] = sign * square;
+    }
+    return t;
+  }
+};
+
+// Returns `f(x), f'(x), ..., f^(K)(x)` of the univariate expression `expr` by
+// propagating a truncated Taylor series of order `K` through every node. Each
+// node costs `O(K^2)` operations and the type of `expr` does not grow with `K`.
+template <
+    std::size_t K,
+    typename E,
+    typename T,
+    std::enable_if_t<detail::is_expression_v<E>>* = nullptr>
+constexpr auto derivatives(const E& expr, T x) noexcept {
+  using S             = detail::scalar_t<T>;
+  const auto series   = expr(taylor<S, K>::variable(static_cast<S>(x)));
+  std::array<S, K + 1> result{};
+  for (std::size_t k = 0; k <= K; ++k) {
+    result[k] = series.derivative(k);
+  }
+  return result;
+}
+
+// Returns the `K`th derivative of the univariate expression `expr` at `x`
+template <
+    std::size_t K,
+    typename E,
+    typename T,
+    std::enable_if_t<detail::is_expression_v<E>>* = nullptr>
+constexpr auto derivative(const E& expr, T x) noexcept {
+  return derivatives<K>(expr, x)[K];
+}
+} // namespace ad
+
+#endif // AUTOMATICDIFFERENTIATION_TAYLOR_HH_1729180311404417386_
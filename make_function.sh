@@ -15,14 +15,20 @@ echo "  return $struct<T>(x);"
 echo "}"
 
 echo "template <typename T>"
-echo "struct $struct : function_expression<$struct<T>> {"
-echo "  using function_expression<$struct>::derive;"
-echo "  friend struct function_expression<$struct<T>>;"
-echo "  [[no_unique_address]] T arg;"
+echo "struct $struct : unary_function<$struct<T>> {"
+echo "  using unary_function<$struct>::derive;"
+echo "  friend struct unary_function<$struct<T>>;"
+echo "  AD_NO_UNIQUE_ADDRESS T arg;"
 echo "  constexpr explicit $struct(T x) noexcept : arg(x) {}"
-echo "  template <typename... Ts>"
-echo "  constexpr double operator()(Ts... xs) const noexcept {"
-echo "    return std::$func(arg(xs...));"
+echo "  template <typename S>"
+echo "  static constexpr S apply(S x) noexcept {"
+echo "    return math<S>::$func(x);"
+echo "  }"
+echo "  template <"
+echo "      typename... Ts,"
+echo "      std::enable_if_t<std::conjunction_v<is_argument<Ts>...>>* = nullptr>"
+echo "  constexpr auto operator()(Ts... xs) const noexcept {"
+echo "    return apply(arg(xs...));"
 echo "  }"
 
 echo "private:"
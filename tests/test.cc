@@ -1,9 +1,25 @@
+// The checks below are `assert`s, which must run in every build type
+#undef NDEBUG
+
 #include "ad/ad.hh"
+#include "ad/batch.hh"
+#include "ad/cse.hh"
+#include "ad/dual.hh"
+#include "ad/fast_math.hh"
+#include "ad/function.hh"
+#include "ad/graph.hh"
+#include "ad/hessian.hh"
+#include "ad/jacobian.hh"
+#include "ad/minimize.hh"
+#include "ad/newton.hh"
 #include "ad/ostream.hh"
+#include "ad/reverse.hh"
+#include "ad/solve.hh"
+#include "ad/taylor.hh"
 
 #include <cassert>
-
-#undef NDEBUG
+#include <limits>
+#include <vector>
 
 template <typename T, typename U>
 constexpr bool same_type(T, U) noexcept {
@@ -21,6 +37,14 @@ int main() {
   constexpr auto y = ad::_1;
 
   static_assert(same_type(123_c, ad::static_constant<123>{}));
+  static_assert(same_type(1_c / 2_c, ad::static_constant<1, 2>{}));
+  static_assert(same_type(2_c / 4_c + 1_c / 3_c, ad::static_constant<5, 6>{}));
+  static_assert(same_type(1_c / 2_c * 4_c - 2_c, 0_c));
+  static_assert(same_type(-(3_c / 6_c), ad::static_constant<-1, 2>{}));
+  static_assert(
+      same_type(ad::pow(2_c / 3_c, -2_c), ad::static_constant<9, 4>{})
+  );
+  static_assert((1_c / 4_c).value() == 0.25);
 
   static_assert(same_type(x.derive(x), 1_c));
   static_assert(same_type(x.derive(y), 0_c));
@@ -29,6 +53,13 @@ int main() {
 
   static_assert(same_type(x.derive(x, x), 0_c));
   static_assert(same_type((x * y).derive(x, y), 1_c));
+  static_assert(same_type(
+      (ad::sin(x) * ad::exp(y)).derive(x, y, x),
+      (ad::sin(x) * ad::exp(y)).derive(y, x, x)
+  ));
+  static_assert(std::is_same_v<
+                ad::detail::derivative_t<decltype(x * x * y), 1, 0>,
+                decltype(2_c * x)>);
 
   static_assert(same_type(ad::log(x).derive(x), 1_c / x));
   static_assert(same_type(ad::exp(x).derive(x), ad::exp(x)));
@@ -49,7 +80,7 @@ int main() {
   static_assert(same_type(-(-x * 1_c), x));
   static_assert(same_type(-0_c, 0_c));
   static_assert(same_type(ad::pow(1_c / x, -1_c), x));
-  static_assert(same_type(ad::exp(1_c) * ad::exp(x), ad::exp(1_c + x)));
+  static_assert(same_type(ad::exp(y) * ad::exp(x), ad::exp(y + x)));
 
   static_assert(same_type(ad::pow(ad::exp(x), 2_c), ad::exp(x * 2_c)));
   static_assert(same_type(ad::pow(ad::pow(x, 2_c), 2_c), ad::pow(x, 4_c)));
@@ -60,6 +91,8 @@ int main() {
   static_assert(sizeof(ad::exp(x)) == 1);
   static_assert(sizeof(x + 1_c) == 1);
   static_assert(sizeof((x + 1_c) * (x - 1_c)) <= 2);
+  static_assert(sizeof(ad::sqrt(x).derive(x)) == 1);
+  static_assert(sizeof(ad::pow(x, 3_c / 2_c).derive(x)) == 1);
 #endif
 
   assert(ad::to_string(1_c / (x * ad::exp(x))) == "1 / (x0 * exp(x0))");
@@ -69,6 +102,9 @@ int main() {
   assert(ad::to_string(-ad::exp(x)) == "-exp(x0)");
   assert(ad::to_string(-(x + 2)) == "-(x0 + 2)");
   assert(ad::to_string(-(x - 2)) == "-(x0 - 2)");
+  assert(ad::to_string(x / 3_c) == "1 / 3 * x0");
+  assert(ad::to_string(ad::pow(x, 2_c / 3_c)) == "x0 ** (2 / 3)");
+  assert(ad::to_string(ad::exp(x) * (-1_c / 2_c)) == "exp(x0) * (-1 / 2)");
 
   static_assert(is_static_expression(x));
   static_assert(is_static_expression(x + 1_c));
@@ -76,4 +112,585 @@ int main() {
 
   static_assert(same_type(ad::sin(x) - ad::sin(x), 0_c));
   static_assert(same_type(ad::sin(x) / ad::sin(x), 1_c));
+
+  {
+    const auto f = ad::exp(ad::sin(x) * y) / (x * x + 2);
+    std::vector<double> xs(200);
+    std::vector<double> ys(200);
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      xs[i] = 0.01 * static_cast<double>(i);
+      ys[i] = 1.0 - 0.005 * static_cast<double>(i);
+    }
+    std::vector<double> out(xs.size());
+    ad::eval(f, xs, ys, out);
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      assert(out[i] == f(xs[i], ys[i]));
+    }
+
+    ad::eval(2_c, xs, out);
+    assert(out.back() == 2);
+    ad::eval(y, xs, ys, out);
+    assert(out == ys);
+  }
+
+  {
+    const auto f = ad::exp(ad::sin(x) * y) / (x * x + 2) + ad::pow(x, 2_c);
+    static_assert(std::is_same_v<decltype(f(1.0f, 2.0f)), float>);
+    static_assert(std::is_same_v<decltype(f(1.0L, 2.0L)), long double>);
+    static_assert(std::is_same_v<decltype(f(1, 2)), double>);
+    assert(std::abs(f(0.5f, 2.0f) - f(0.5, 2.0)) < 1e-6);
+
+    std::vector<float> xs{0.5f, 1.0f};
+    std::vector<float> ys{2.0f, 3.0f};
+    std::vector<float> out(xs.size());
+    ad::eval(f, xs, ys, out);
+    assert(out[1] == f(1.0f, 3.0f));
+  }
+
+  {
+    const auto df = ad::exp(ad::sin(x)).derive(x);
+    using subexpressions = decltype(ad::cse(df))::subexpressions;
+    static_assert(subexpressions::size == 4);
+    assert(ad::cse(df)(0.5) == df(0.5));
+
+    const auto g   = ad::tan(x * y) + ad::sqrt(x) * 2;
+    const auto d3g = g.derive(x, x, y);
+    assert(std::abs(ad::cse(d3g)(0.5, 1.5) - d3g(0.5, 1.5)) < 1e-12);
+  }
+
+  {
+    const auto z = ad::_2;
+    const auto f = ad::exp(x * y) * ad::sin(z) + ad::pow(x, y) / ad::sqrt(z)
+                 + ad::atan(y) - ad::pow(z, 2_c);
+    const auto result = ad::value_and_gradient(f, 0.5, 1.5, 2.0);
+    static_assert(std::is_same_v<decltype(result), const ad::dual<double, 3>>);
+    assert(std::abs(result.value - f(0.5, 1.5, 2.0)) < 1e-12);
+    assert(std::abs(result.gradient[0] - f.derive(x)(0.5, 1.5, 2.0)) < 1e-12);
+    assert(std::abs(result.gradient[1] - f.derive(y)(0.5, 1.5, 2.0)) < 1e-12);
+    assert(std::abs(result.gradient[2] - f.derive(z)(0.5, 1.5, 2.0)) < 1e-12);
+
+    const auto g = ad::pow(x, 2_c);
+    assert(ad::value_and_gradient(g, -2).gradient[0] == -4);
+  }
+
+  {
+    const auto z = ad::_2;
+    const auto f = ad::exp(x * y) * ad::sin(z) + ad::pow(x, y) / ad::sqrt(z)
+                 - ad::acosh(z) * ad::tanh(-x) + ad::pow(z, 3_c);
+    const auto forward = ad::value_and_gradient(f, 0.5, 1.5, 2.0);
+    const auto reverse =
+        ad::value_and_gradient(ad::reverse_mode, f, 0.5, 1.5, 2.0);
+    assert(forward.value == reverse.value);
+    for (std::size_t i = 0; i < 3; ++i) {
+      assert(std::abs(forward.gradient[i] - reverse.gradient[i]) < 1e-12);
+    }
+  }
+
+  {
+    ad::graph g;
+    const auto gx = g.variable(0);
+    const auto gy = g.variable(1);
+    auto loss     = g.constant(0.0);
+    for (int i = 0; i < 3; ++i) {
+      loss = loss + ad::pow(gx * i - gy, 2.0) + ad::sin(gx) * ad::exp(gy);
+    }
+
+    const auto f = (x * 0 - y) * (x * 0 - y) + (x * 1 - y) * (x * 1 - y)
+                 + (x * 2 - y) * (x * 2 - y) + 3 * ad::sin(x) * ad::exp(y);
+    std::vector<double> gradient(2);
+    for (double p : {0.5, 1.0, 2.0}) {
+      const std::vector<double> inputs{p, 1.5};
+      const double value = g.gradient(loss, inputs, gradient);
+      const auto expected = ad::value_and_gradient(f, p, 1.5);
+      assert(std::abs(value - expected.value) < 1e-12);
+      assert(std::abs(g.evaluate(loss, inputs) - expected.value) < 1e-12);
+      assert(std::abs(gradient[0] - expected.gradient[0]) < 1e-12);
+      assert(std::abs(gradient[1] - expected.gradient[1]) < 1e-12);
+    }
+
+    const auto h    = ad::atan(x / y) + ad::acosh(x + y) - ad::pow(y, x);
+    const auto node = g.insert(h);
+    const std::vector<double> inputs{0.5, 1.5};
+    assert(std::abs(g.gradient(node, inputs, gradient) - h(0.5, 1.5)) < 1e-12);
+    assert(std::abs(gradient[0] - h.derive(x)(0.5, 1.5)) < 1e-12);
+    assert(std::abs(gradient[1] - h.derive(y)(0.5, 1.5)) < 1e-12);
+  }
+
+  {
+    const auto z  = ad::_2;
+    const auto f0 = ad::exp(x * y) + ad::sin(z);
+    const auto f1 = ad::exp(x * y) * z - 2_c * y;
+    const auto fs = ad::make_vector(f0, f1);
+
+    const auto values = fs(0.5, 1.5, 2.0);
+    assert(values[0] == f0(0.5, 1.5, 2.0));
+    assert(values[1] == f1(0.5, 1.5, 2.0));
+
+    std::array<double, 6> row_major{};
+    std::array<double, 6> column_major{};
+    assert(ad::jacobian(fs, row_major, 0.5, 1.5, 2.0) == values);
+    ad::jacobian<ad::layout::column_major>(fs, column_major, 0.5, 1.5, 2.0);
+    const std::array<double, 6> expected{
+        f0.derive(x)(0.5, 1.5, 2.0),
+        f0.derive(y)(0.5, 1.5, 2.0),
+        f0.derive(z)(0.5, 1.5, 2.0),
+        f1.derive(x)(0.5, 1.5, 2.0),
+        f1.derive(y)(0.5, 1.5, 2.0),
+        f1.derive(z)(0.5, 1.5, 2.0),
+    };
+    for (std::size_t i = 0; i < 2; ++i) {
+      for (std::size_t j = 0; j < 3; ++j) {
+        assert(std::abs(row_major[i * 3 + j] - expected[i * 3 + j]) < 1e-12);
+        assert(column_major[j * 2 + i] == row_major[i * 3 + j]);
+      }
+    }
+  }
+
+  {
+    const auto f = ad::exp(x * y) / (x + 2_c) + ad::pow(x, 3_c) * ad::sin(y)
+                 + ad::pow(x, y) - ad::atan(x / y);
+
+    std::array<double, 4> h{};
+    assert(ad::hessian(f, h, 0.5, 1.5) == f(0.5, 1.5));
+    const std::array<double, 4> expected{
+        f.derive(x, x)(0.5, 1.5),
+        f.derive(x, y)(0.5, 1.5),
+        f.derive(y, x)(0.5, 1.5),
+        f.derive(y, y)(0.5, 1.5),
+    };
+    for (std::size_t i = 0; i < 4; ++i) {
+      assert(std::abs(h[i] - expected[i]) < 1e-12);
+    }
+
+    const auto result = ad::value_gradient_and_hessian(f, 0.5, 1.5);
+    assert(std::abs(result.gradient[0] - f.derive(x)(0.5, 1.5)) < 1e-12);
+    assert(std::abs(result.gradient[1] - f.derive(y)(0.5, 1.5)) < 1e-12);
+    assert(result.second(1, 0) == h[1]);
+  }
+
+  {
+    const auto f = ad::sin(x) * ad::exp(x) / (x + 2_c) + ad::pow(x, 3_c)
+                 + ad::atan(ad::sqrt(x)) - ad::tanh(ad::log(x));
+    const auto df = f.derive();
+    const auto d2f = df.derive();
+    const auto d3f = d2f.derive();
+
+    const auto ds = ad::derivatives<3>(f, 0.7);
+    assert(std::abs(ds[0] - f(0.7)) < 1e-12);
+    assert(std::abs(ds[1] - df(0.7)) < 1e-12);
+    assert(std::abs(ds[2] - d2f(0.7)) < 1e-12);
+    assert(std::abs(ds[3] - d3f(0.7)) < 1e-10);
+
+    const auto g = ad::cosh(x) + ad::tan(x) - ad::acos(x) + ad::asin(x)
+                 + ad::sinh(x) * ad::cos(x) + ad::asinh(x) + ad::atanh(x)
+                 + ad::acosh(x + 2_c) + ad::pow(x, x);
+    assert(std::abs(ad::derivative<2>(g, 0.3) - g.derive(x, x)(0.3)) < 1e-12);
+
+    assert(ad::derivative<4>(ad::sin(x), 0.3) == std::sin(0.3));
+    assert(ad::derivative<3>(ad::pow(x, 2_c), 0.0) == 0.0);
+    assert(ad::derivative<2>(ad::pow(x, 2_c), 0.0) == 2.0);
+  }
+
+  {
+    static_assert(same_type(ad::canonicalize(x * y + y * x), 2_c * (x * y)));
+    static_assert(same_type(ad::canonicalize(2_c * (3_c * x)), 6_c * x));
+    static_assert(same_type(ad::canonicalize(x / 2_c + x / 2_c), x));
+    static_assert(same_type(
+        ad::canonicalize(x / 2_c + y / 2_c), 1_c / 2_c * (x + y)
+    ));
+    static_assert(same_type(ad::canonicalize(x * y - y * x), 0_c));
+    static_assert(
+        same_type(ad::canonicalize(y + x), ad::canonicalize(x + y))
+    );
+    static_assert(same_type(ad::canonicalize(x * x + x * y), x * (x + y)));
+    static_assert(same_type(
+        ad::canonicalize(x / y - x * ad::exp(y)), x * (1_c / y - ad::exp(y))
+    ));
+
+    const auto f  = ad::exp(ad::sin(x)) * ad::log(1_c + x * x) / (y + 2_c);
+    const auto d3 = f.derive().derive().derive(y);
+    assert(std::abs(f.derive(x, y, x)(0.7, 0.2) - d3(0.7, 0.2)) < 1e-12);
+    assert(std::abs(ad::canonicalize(d3)(0.7, 0.2) - d3(0.7, 0.2)) < 1e-12);
+
+    const auto g = ad::canonicalize(ad::sin(x + x) * 2.0 + x * x);
+    assert(std::abs(g(0.3) - (std::sin(0.6) * 2.0 + 0.09)) < 1e-12);
+  }
+
+  {
+    const auto f = ad::pow(x, 5_c) - ad::pow(x, -2_c) + ad::pow(x, 1_c / 2_c)
+                 + ad::pow(x, -3_c / 2_c) + ad::pow(x, 2_c / 3_c);
+    const double t = 1.7;
+    const double expected = std::pow(t, 5.0) - std::pow(t, -2.0)
+                          + std::pow(t, 0.5) + std::pow(t, -1.5)
+                          + std::pow(t, 2.0 / 3.0);
+    assert(std::abs(f(t) - expected) < 1e-12);
+    assert(std::abs(f.derive(x)(t) - ad::derivative<1>(f, t)) < 1e-12);
+
+    const auto reverse = ad::value_and_gradient(ad::reverse_mode, f, t);
+    assert(std::abs(reverse.gradient[0] - f.derive(x)(t)) < 1e-12);
+
+    assert(ad::pow(x, 3_c)(-2.0) == -8.0);
+    assert(ad::pow(x, 0_c)(0.0) == 1.0);
+  }
+
+  {
+    // `x * y - 1` is exactly `-2^-60`, but the rounded product is one
+    const double a = 1 + std::ldexp(1.0, -30);
+    const double b = 1 - std::ldexp(1.0, -30);
+    const auto f   = x * y - 1_c;
+#if AD_FMA
+    assert(f(a, b) == -std::ldexp(1.0, -60));
+#else
+    assert(f(a, b) == 0.0);
+#endif
+    assert(ad::cse(f)(a, b) == f(a, b));
+    assert((1_c - y * x)(a, b) == -f(a, b));
+
+    const std::vector<double> xs{a, a};
+    const std::vector<double> ys{b, b};
+    std::vector<double> out(2);
+    ad::eval(f + (x + 2_c) * y, xs, ys, out);
+    assert(out[1] == (f + (x + 2_c) * y)(a, b));
+  }
+
+  {
+    const auto f = ad::sin(x * y) * ad::cosh(y) + ad::exp(x) / ad::exp(-x)
+                 + ad::sinh(x - y) * ad::cos(x * y) + ad::exp(-y) * ad::exp(y);
+    const auto df = f.derive(x, y);
+    for (double t : {-3.0, 0.2, 1.5, 30.0}) {
+      const double direct = df(0.3, t);
+      const double shared = ad::cse(df)(0.3, t);
+      assert(std::abs(shared - direct) <= 1e-14 * std::abs(direct));
+    }
+
+    // The shortcuts stay within the range of `float`
+    const auto g = ad::sinh(x) + ad::cosh(x) + ad::exp(x) * ad::exp(-x);
+    for (float t : {-50.0f, 0.5f, 50.0f, 87.0f}) {
+      const float direct = g(t);
+      const float shared = ad::cse(g)(t);
+      assert(std::isfinite(direct));
+      assert(std::abs(shared - direct) <= 1e-6f * std::abs(direct));
+    }
+  }
+
+  {
+    // Within 4 ulp of the standard library for every function
+    const auto close = [](ad::fast<double> approx, double exact) {
+      const double eps = std::numeric_limits<double>::epsilon();
+      return std::abs(approx.value - exact) <= 4 * eps * std::abs(exact);
+    };
+    for (double t : {-0.9, -0.3, 1e-8, 0.5, 0.99}) {
+      const ad::fast u = t;
+      assert(close(ad::exp(x)(u), std::exp(t)));
+      assert(close(ad::sin(x)(u), std::sin(t)));
+      assert(close(ad::cos(x)(u), std::cos(t)));
+      assert(close(ad::tan(x)(u), std::tan(t)));
+      assert(close(ad::sinh(x)(u), std::sinh(t)));
+      assert(close(ad::cosh(x)(u), std::cosh(t)));
+      assert(close(ad::tanh(x)(u), std::tanh(t)));
+      assert(close(ad::asin(x)(u), std::asin(t)));
+      assert(close(ad::acos(x)(u), std::acos(t)));
+      assert(close(ad::atan(x)(u), std::atan(t)));
+      assert(close(ad::asinh(x)(u), std::asinh(t)));
+      assert(close(ad::atanh(x)(u), std::atanh(t)));
+    }
+    for (double t : {1.0, 1.5, 40.0, 1e300}) {
+      const ad::fast u = t;
+      assert(close(ad::log(x)(u), std::log(t)));
+      assert(close(ad::sqrt(x)(u), std::sqrt(t)));
+      assert(close(ad::acosh(x)(u), std::acosh(t)));
+      assert(close(ad::exp(x)(-u), std::exp(-t)));
+    }
+    assert(ad::exp(x)(ad::fast(1e3)).value == HUGE_VAL);
+    assert(ad::log(x)(ad::fast(0.0)).value == -HUGE_VAL);
+    assert(std::isnan(ad::log(x)(ad::fast(-1.0)).value));
+
+    const auto f  = ad::exp(ad::sin(x)) * ad::log(1_c + x * x) / (y + 2_c);
+    const auto df = f.derive(x, y);
+    const auto r  = df(ad::fast(0.7), 0.2);
+    assert(std::abs(r.value - df(0.7, 0.2)) < 1e-14);
+    assert(std::abs(ad::cse(df)(ad::fast(0.7), 0.2).value - r.value) < 1e-14);
+    assert(std::abs(f(0.7f, ad::fast(0.2f)).value - f(0.7f, 0.2f)) < 1e-6f);
+
+    const std::vector<ad::fast<double>> xs{0.7, -0.1};
+    const std::vector<ad::fast<double>> ys{0.2, 0.2};
+    std::vector<ad::fast<double>> out(2);
+    ad::eval(df, xs, ys, out);
+    assert(out[0] == r);
+  }
+
+  {
+    static_assert(same_type(x / 4_c, 1_c / 4_c * x));
+    static_assert(same_type(x / -2_c / 3_c, -1_c / 6_c * x));
+    static_assert(same_type(1_c / ad::sqrt(x), ad::pow(x, -1_c / 2_c)));
+    static_assert(
+        same_type(ad::asin(x).derive(), ad::pow(1_c - x * x, -1_c / 2_c))
+    );
+    assert((x / 4.0)(3.0) == 0.75);
+    assert((ad::exp(x) / 2.0)(0.0) == 0.5);
+
+    // Divisors whose reciprocal overflows or is subnormal are divided by
+    const auto tiny = x / 1e-310;
+    const auto huge = x / 1e308;
+    assert(tiny(1e-300) == 1e-300 / 1e-310 && huge(1e300) == 1e300 / 1e308);
+    assert(tiny.derive()(1.0) == 1 / 1e-310);
+    const std::vector<double> ts{1e-300, 2e-300};
+    std::vector<double> quotients(2);
+    ad::eval(tiny, ts, quotients);
+    assert(quotients[0] == 1e-300 / 1e-310 && quotients[1] == 2e-300 / 1e-310);
+
+    const auto f = ad::asin(x) + ad::acos(x) * ad::asinh(x) + x / 3.0;
+    const double t = 0.4;
+    const double expected =
+        1 / std::sqrt(1 - t * t) - std::asinh(t) / std::sqrt(1 - t * t)
+        + std::acos(t) / std::sqrt(1 + t * t) + 1 / 3.0;
+    assert(std::abs(f.derive()(t) - expected) < 1e-14);
+    assert(std::abs(f.derive(x, x)(t) - ad::derivative<2>(f, t)) < 1e-12);
+
+    const auto g = ad::sin(x) * ad::sin(x) + ad::exp(x) * ad::exp(x) * x;
+    const std::vector<double> xs{0.5};
+    std::vector<double> out(1);
+    ad::eval(g, xs, out);
+    assert(std::abs(out[0] - g(0.5)) < 1e-15);
+    assert(std::abs(g(0.5) - (std::pow(std::sin(0.5), 2) + std::exp(1.0) * 0.5))
+           < 1e-15);
+  }
+
+  {
+    static_assert(same_type((x * x * x + x).derive().derive(), 6_c * x));
+    static_assert(same_type(
+        ad::canonicalize(x * x * x + x), ad::canonicalize(x + x * x * x)
+    ));
+    assert(ad::to_string((x * x * x - x).derive()) == "-1 + 3 * x0 ** 2");
+
+    const auto f    = (x + 1_c) * (x - 1_c) * (x * x + 2_c) * (x - 3_c);
+    const auto df   = f.derive();
+    const double t  = 1.5;
+    const double d1 = (((5 * t - 12) * t + 3) * t - 6) * t - 2;
+    const double d2 = ((20 * t - 36) * t + 6) * t - 6;
+    const double d3 = (60 * t - 72) * t + 6;
+    assert(std::abs(df(t) - d1) < 1e-12);
+    assert(std::abs(df.derive().derive()(t) - d3) < 1e-12);
+    assert(std::abs(f.derive(x, x, x)(t) - d3) < 1e-12);
+    assert(std::abs(ad::derivative<2>(df, t) - d3) < 1e-12);
+    const auto reverse = ad::value_and_gradient(ad::reverse_mode, df, t);
+    assert(std::abs(reverse.gradient[0] - d2) < 1e-12);
+    assert(std::abs(ad::cse(df)(t) - df(t)) < 1e-12);
+
+    ad::graph g;
+    const auto node = g.insert(df);
+    const std::array<double, 1> inputs{t};
+    assert(std::abs(g.evaluate(node, inputs) - df(t)) < 1e-12);
+
+    // Polynomials of high degree are evaluated by Estrin's scheme
+    const auto h = ad::pow(x + 1_c, 10_c).derive();
+    assert(std::abs(h(0.5) - 10 * std::pow(1.5, 9)) < 1e-10);
+    const std::vector<double> xs{0.5, -2.0};
+    std::vector<double> out(2);
+    ad::eval(h, xs, out);
+    assert(out[0] == h(0.5) && out[1] == h(-2.0));
+  }
+
+  {
+    // Built during constant evaluation the functions of constants are
+    // computed on every evaluation and otherwise once when they are built
+    constexpr auto f = ad::exp(1_c) * x;
+    constexpr auto g = ad::pow(2_c, x).derive(x);
+    assert(f(2.0) == std::exp(1.0) * 2.0);
+    assert(std::abs(g(3.0) - 8 * std::log(2.0)) < 1e-14);
+
+    const auto h = ad::pow(2_c, x).derive(x);
+    assert(h(3.0) == g(3.0));
+    assert(ad::exp(1_c).value() == std::exp(1.0));
+    assert(ad::sin(ad::cos(2.0))(0.0) == std::sin(std::cos(2.0)));
+    assert(ad::pow(2_c, 1_c / 3_c).value() == std::pow(2.0, 1.0 / 3.0));
+    assert(ad::log(ad::sqrt(2.0)).value() == std::log(std::sqrt(2.0)));
+    const auto c = ad::exp(1_c) - ad::log(2_c);
+    assert(c.value() == std::exp(1.0) - std::log(2.0));
+    assert((x / ad::exp(1_c))(2.0) == 2.0 * (1.0 / std::exp(1.0)));
+
+    static_assert(same_type(
+        -ad::runtime_constant{1.0}, ad::runtime_constant{0.0}
+    ));
+    static_assert((-ad::runtime_constant{1.0}).value() == -1.0);
+  }
+
+  {
+    constexpr auto z = ad::var<23>;
+    const auto f     = ad::sin(x) * z + 2_c * x / y;
+    std::vector<double> xs(24, 1.0);
+    xs[0]  = 0.5;
+    xs[23] = 3.0;
+    assert(ad::evaluate(f, xs) == f(0.5, 1.0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                                      1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3.0));
+    const auto df = f.derive(x);
+    assert(ad::cse(df)(ad::context<double>{xs.data()}) == ad::evaluate(df, xs));
+
+    constexpr std::array<int, 2> is{3, 2};
+    static_assert(ad::evaluate(x * x / y, is) == 4.5);
+    static_assert(ad::detail::arity_v<std::remove_const_t<decltype(f)>> == 24);
+  }
+
+  {
+    // The last expression holds more runtime constants than fit inline
+    std::vector<ad::function<2, 16>> fs{
+        ad::sin(x) * y, x * x + 2_c * y, 1.0 + 2.0 * x + 3.0 * y + 4.0 * x * y};
+    fs.push_back(fs[2]);
+    fs.push_back(fs[0]);
+    const std::vector<double> xs{0.5, 1.0, 2.0};
+    const std::vector<double> ys{1.0, 2.0, -1.0};
+    std::vector<double> out(3);
+    std::vector<double> values(3);
+    std::vector<double> gradients(6);
+    const auto check = [&](const auto& f, const auto& expr) {
+      f.eval(xs, ys, out);
+      f.gradient(xs, ys, values, gradients);
+      for (std::size_t i = 0; i < xs.size(); ++i) {
+        const auto expected = ad::value_and_gradient(expr, xs[i], ys[i]);
+        assert(std::abs(f(xs[i], ys[i]) - expected.value) < 1e-14);
+        assert(std::abs(out[i] - expected.value) < 1e-14);
+        assert(std::abs(values[i] - expected.value) < 1e-14);
+        assert(std::abs(gradients[2 * i] - expected.gradient[0]) < 1e-14);
+        assert(std::abs(gradients[2 * i + 1] - expected.gradient[1]) < 1e-14);
+      }
+    };
+    check(fs[0], ad::sin(x) * y);
+    check(fs[1], x * x + 2_c * y);
+    check(fs[3], 1.0 + 2.0 * x + 3.0 * y + 4.0 * x * y);
+    check(fs[4], ad::sin(x) * y);
+
+    ad::function<2, 16> g = std::move(fs[1]);
+    assert(g && !fs[1]);
+    fs[1] = fs[3];
+    fs[3] = g;
+    check(fs[1], 1.0 + 2.0 * x + 3.0 * y + 4.0 * x * y);
+    check(fs[3], x * x + 2_c * y);
+  }
+
+  {
+    // More lanes than one block, split across threads
+    constexpr std::size_t n = 1000;
+    const std::vector<double> starts(n, 1.0);
+    std::vector<double> ps(n);
+    std::vector<double> roots(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      ps[i] = 0.5 + 0.01 * static_cast<double>(i);
+    }
+    ad::newton_options options;
+    options.threads          = 3;
+    options.lanes_per_thread = 100;
+    const auto result =
+        ad::find_roots(x * ad::exp(x) - y, starts, ps, roots, options);
+    assert(result.converged == n && result.iterations < 20);
+    for (std::size_t i = 0; i < n; ++i) {
+      assert(std::abs(roots[i] * std::exp(roots[i]) - ps[i]) < 1e-12 * ps[i]);
+    }
+
+    // The derivative of `cos` vanishes at the second start and the third
+    // start runs out of iterations
+    const std::vector<double> xs{1.0, 0.0, 3.0};
+    std::vector<double> zeros(3);
+    options.max_iterations = 3;
+    const auto cosine = ad::find_roots(ad::cos(x), xs, zeros);
+    assert(cosine.converged == 2);
+    assert(std::abs(zeros[0] - std::acos(0.0)) < 1e-15 && std::isnan(zeros[1]));
+    assert(ad::find_roots(ad::cos(x), xs, zeros, options).converged == 0);
+    assert(std::isnan(zeros[2]));
+
+    // A start on a double root has a vanishing derivative but is a root
+    const std::vector<double> origin{0.0};
+    std::vector<double> root{1.0};
+    assert(ad::find_roots(x * x, origin, root).converged == 1 && root[0] == 0);
+  }
+
+  {
+    // Intersection of a circle and an exponential
+    const auto fs = ad::make_vector(x * x + y * y - 4_c, ad::exp(x) + y - 1_c);
+    std::array<double, 2> xs{1.0, -1.0};
+    const auto result = ad::solve(fs, xs);
+    assert(result.converged && result.iterations < 10);
+    assert(std::abs(xs[0] * xs[0] + xs[1] * xs[1] - 4) < 1e-14);
+    assert(std::abs(std::exp(xs[0]) + xs[1] - 1) < 1e-14);
+
+    // The Jacobian is singular at the origin
+    const auto singular = ad::make_vector(x * x - 1_c, y * y - 1_c);
+    std::array<double, 2> zero{0.0, 0.0};
+    assert(!ad::solve(singular, zero).converged);
+
+    // The Rosenbrock function as least squares, damped and undamped
+    const auto rosenbrock = ad::make_vector(10_c * (y - x * x), 1_c - x);
+    ad::solver_workspace<2, 2> workspace;
+    ad::solver_options options;
+    for (const double damping : {1e-3, 0.0}) {
+      options.damping = damping;
+      std::array<double, 2> ys{-1.2, 1.0};
+      const auto fit = ad::least_squares(rosenbrock, ys, workspace, options);
+      assert(fit.converged && fit.cost < 1e-24);
+      assert(std::abs(ys[0] - 1) < 1e-12 && std::abs(ys[1] - 1) < 1e-12);
+    }
+
+    // More residuals than variables
+    const auto line = ad::make_vector(x + y - 1_c, x - y - 1_c, x - 2_c);
+    std::array<double, 2> zs{0.0, 0.0};
+    const auto fit = ad::least_squares(line, zs);
+    assert(fit.converged);
+    assert(std::abs(zs[0] - 4.0 / 3.0) < 1e-12 && std::abs(zs[1]) < 1e-12);
+    assert(std::abs(fit.cost - 1.0 / 3.0) < 1e-12);
+  }
+
+  {
+    // The Rosenbrock function
+    const auto f = 100_c * ad::pow(y - x * x, 2_c) + ad::pow(1_c - x, 2_c);
+    std::size_t iterations = 0;
+    const auto count       = [&](const ad::minimizer_progress& progress) {
+      assert(progress.iteration == ++iterations);
+      assert(progress.evaluations > progress.iteration);
+    };
+    std::array<double, 2> xs{-1.2, 1.0};
+    const auto lbfgs = ad::minimize_lbfgs(f, xs, {}, count);
+    assert(lbfgs.converged && lbfgs.iterations == iterations);
+    assert(lbfgs.evaluations < 100 && lbfgs.value < 1e-20);
+    assert(std::abs(xs[0] - 1) < 1e-10 && std::abs(xs[1] - 1) < 1e-10);
+
+    xs = {-1.2, 1.0};
+    ad::newton_workspace<2> workspace;
+    const auto newton = ad::minimize_newton(f, xs, workspace);
+    assert(newton.converged && newton.evaluations == newton.iterations + 1);
+    assert(newton.iterations < 40 && newton.value < 1e-20);
+    assert(std::abs(xs[0] - 1) < 1e-10 && std::abs(xs[1] - 1) < 1e-10);
+
+    // Newton's method leaves the saddle point at the origin along the negative
+    // curvature although the gradient has no component along it
+    const auto g = ad::pow(x, 4_c) - 2_c * x * x + y * y;
+    xs           = {0.0, 0.5};
+    assert(ad::minimize_newton(g, xs, workspace).converged);
+    assert(std::abs(std::abs(xs[0]) - 1) < 1e-10 && std::abs(xs[1]) < 1e-10);
+
+    // A memory of two steps and too few iterations
+    std::array<double, 3> zs{-1.2, 1.0, 0.5};
+    ad::lbfgs_workspace<3, 2> memory;
+    ad::minimizer_options options;
+    const auto h = f + ad::pow(ad::_2 - y, 2_c);
+    assert(ad::minimize_lbfgs(h, zs, memory, options).converged);
+    assert(std::abs(zs[2] - 1) < 1e-10);
+    zs                     = {-1.2, 1.0, 0.5};
+    options.max_iterations = 3;
+    const auto stopped     = ad::minimize_lbfgs(h, zs, memory, options);
+    assert(!stopped.converged && stopped.iterations == 3);
+  }
+
+  {
+    // Nodes the output does not depend on stay out of the reverse sweep, even
+    // with infinite partials at the evaluation point
+    ad::graph g;
+    const auto gx = g.variable(0);
+    ad::log(gx);
+    const auto f = gx * gx + 1.0;
+    ad::sqrt(gx);
+    const auto k = gx * 3.0;
+    const std::vector<double> inputs{0.0};
+    std::vector<double> gradient(1);
+    assert(g.gradient(f, inputs, gradient) == 1.0 && gradient[0] == 0.0);
+    assert(g.gradient(k, inputs, gradient) == 0.0 && gradient[0] == 3.0);
+  }
 }